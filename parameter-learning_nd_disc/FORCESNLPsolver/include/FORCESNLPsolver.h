@@ -30,9 +30,17 @@ jurisdiction in case of any dispute.
 #define __FORCESNLPsolver_H__
 
 /* DATA TYPE ------------------------------------------------------------*/
+/* single precision if FORCESNLPsolver_SINGLE_PRECISION is defined; solver,
+ * model and interfaces must all be compiled with the same setting */
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+typedef float FORCESNLPsolver_float;
+
+typedef float FORCESNLPsolverinterface_float;
+#else
 typedef double FORCESNLPsolver_float;
 
 typedef double FORCESNLPsolverinterface_float;
+#endif
 
 #ifndef __SOLVER_STANDARD_TYPES__
 #define __SOLVER_STANDARD_TYPES__
@@ -85,28 +93,88 @@ typedef long long int solver_int64_default;
 /* #define PRINTNUMERICALWARNINGS */
 
 /* maximum number of iterations  */
-#define FORCESNLPsolver_SET_MAXIT			(5000)	
+#define FORCESNLPsolver_DEFAULT_MAXIT			(5000)	
 
 /* scaling factor of line search (FTB rule) */
-#define FORCESNLPsolver_SET_FLS_SCALE		(FORCESNLPsolver_float)(0.99)      
+#define FORCESNLPsolver_DEFAULT_FLS_SCALE		(FORCESNLPsolver_float)(0.99)      
 
-/* maximum number of supported elements in the filter */
+/* maximum number of supported elements in the filter,
+ * FORCESNLPsolver_build.py --filter-size=N sets it */
+#ifndef FORCESNLPsolver_MAX_FILTER_SIZE
 #define FORCESNLPsolver_MAX_FILTER_SIZE	(5000) 
+#endif
 
-/* maximum number of supported elements in the filter */
-#define FORCESNLPsolver_MAX_SOC_IT			(4) 
+/* maximum number of second order correction iterations */
+#define FORCESNLPsolver_DEFAULT_MAX_SOC_IT			(4) 
 
 /* desired relative duality gap */
-#define FORCESNLPsolver_SET_ACC_RDGAP		(FORCESNLPsolver_float)(0.0001)
+#define FORCESNLPsolver_DEFAULT_ACC_RDGAP		(FORCESNLPsolver_float)(0.0001)
 
 /* desired maximum residual on equality constraints */
-#define FORCESNLPsolver_SET_ACC_RESEQ		(FORCESNLPsolver_float)(1E-06)
+#define FORCESNLPsolver_DEFAULT_ACC_RESEQ		(FORCESNLPsolver_float)(1E-06)
 
 /* desired maximum residual on inequality constraints */
-#define FORCESNLPsolver_SET_ACC_RESINEQ	(FORCESNLPsolver_float)(1E-06)
+#define FORCESNLPsolver_DEFAULT_ACC_RESINEQ	(FORCESNLPsolver_float)(1E-06)
 
 /* desired maximum violation of complementarity */
-#define FORCESNLPsolver_SET_ACC_KKTCOMPL	(FORCESNLPsolver_float)(1E-06)
+#define FORCESNLPsolver_DEFAULT_ACC_KKTCOMPL	(FORCESNLPsolver_float)(1E-06)
+
+
+/* RUNTIME SETTINGS -----------------------------------------------------*/
+/* A solver compiled with FORCESNLPsolver_RUNTIME_SETTINGS (see
+ * FORCESNLPsolver_build.py --runtime-settings) reads the settings below from
+ * FORCESNLPsolver_runtime_settings, which FORCESNLPsolver_solve_ctx sets from
+ * the solver context before each solve. Otherwise the defaults above are
+ * compiled in and the settings of the context have no effect, except for
+ * printlevel. The filter size and whether printing and timing code is
+ * compiled in at all (FORCESNLPsolver_SET_PRINTLEVEL, FORCESNLPsolver_SET_TIMING)
+ * stay compile-time choices. */
+typedef struct FORCESNLPsolver_settings
+{
+    /* desired relative duality gap */
+    FORCESNLPsolver_float acc_rdgap;
+
+    /* desired maximum residual on equality constraints */
+    FORCESNLPsolver_float acc_reseq;
+
+    /* desired maximum residual on inequality constraints */
+    FORCESNLPsolver_float acc_resineq;
+
+    /* desired maximum violation of complementarity */
+    FORCESNLPsolver_float acc_kktcompl;
+
+    /* scaling factor of line search (FTB rule) */
+    FORCESNLPsolver_float fls_scale;
+
+    /* maximum number of iterations */
+    solver_int32_default maxit;
+
+    /* maximum number of second order correction iterations */
+    solver_int32_default max_soc_it;
+
+    /* 0 prints nothing, in any build; otherwise as compiled in */
+    solver_int32_default printlevel;
+
+} FORCESNLPsolver_settings;
+
+#ifdef FORCESNLPsolver_RUNTIME_SETTINGS
+extern FORCESNLPsolver_settings FORCESNLPsolver_runtime_settings;
+#define FORCESNLPsolver_SET_ACC_RDGAP		(FORCESNLPsolver_runtime_settings.acc_rdgap)
+#define FORCESNLPsolver_SET_ACC_RESEQ		(FORCESNLPsolver_runtime_settings.acc_reseq)
+#define FORCESNLPsolver_SET_ACC_RESINEQ	(FORCESNLPsolver_runtime_settings.acc_resineq)
+#define FORCESNLPsolver_SET_ACC_KKTCOMPL	(FORCESNLPsolver_runtime_settings.acc_kktcompl)
+#define FORCESNLPsolver_SET_FLS_SCALE		(FORCESNLPsolver_runtime_settings.fls_scale)
+#define FORCESNLPsolver_SET_MAXIT			(FORCESNLPsolver_runtime_settings.maxit)
+#define FORCESNLPsolver_MAX_SOC_IT			(FORCESNLPsolver_runtime_settings.max_soc_it)
+#else
+#define FORCESNLPsolver_SET_ACC_RDGAP		FORCESNLPsolver_DEFAULT_ACC_RDGAP
+#define FORCESNLPsolver_SET_ACC_RESEQ		FORCESNLPsolver_DEFAULT_ACC_RESEQ
+#define FORCESNLPsolver_SET_ACC_RESINEQ	FORCESNLPsolver_DEFAULT_ACC_RESINEQ
+#define FORCESNLPsolver_SET_ACC_KKTCOMPL	FORCESNLPsolver_DEFAULT_ACC_KKTCOMPL
+#define FORCESNLPsolver_SET_FLS_SCALE		FORCESNLPsolver_DEFAULT_FLS_SCALE
+#define FORCESNLPsolver_SET_MAXIT			FORCESNLPsolver_DEFAULT_MAXIT
+#define FORCESNLPsolver_MAX_SOC_IT			FORCESNLPsolver_DEFAULT_MAX_SOC_IT
+#endif
 
 
 /* RETURN CODES----------------------------------------------------------*/
@@ -0,0 +1,218 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+C++17 front-end of the solver context, header only.
+
+Solver<> owns one FORCESNLPsolver_context and hands out fixed-size views of
+its parameters and results, so the dimensions are compile-time constants and
+nothing is copied between the caller and the C structures. Link against the
+solver library as for the C interface.
+
+*/
+
+#ifndef __FORCESNLPsolver_HPP__
+#define __FORCESNLPsolver_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+#include "FORCESNLPsolver_context.h"
+
+extern "C" void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
+
+namespace FORCESNLPsolver {
+
+using Float = FORCESNLPsolver_float;
+
+
+/* VIEWS ----------------------------------------------------------------*/
+/* fixed-extent subset of std::span, which C++17 lacks; converts to
+ * std::span<T, Extent> where there is one */
+template <class T, std::size_t Extent>
+class View
+{
+public:
+    using element_type = T;
+    using iterator = T *;
+
+    static constexpr std::size_t extent = Extent;
+
+    constexpr explicit View(T *data) noexcept : data_(data) {}
+
+    /* View<const T> from View<T> */
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    constexpr View(const View<U, Extent> &other) noexcept : data_(other.data()) {}
+
+#if defined(__cpp_lib_span)
+    constexpr operator std::span<T, Extent>() const noexcept { return std::span<T, Extent>(data_, Extent); }
+#endif
+
+    constexpr T *data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return Extent; }
+    constexpr T &operator[](std::size_t i) const noexcept { return data_[i]; }
+    constexpr iterator begin() const noexcept { return data_; }
+    constexpr iterator end() const noexcept { return data_ + Extent; }
+
+    /* elements [Offset, Offset + Count) */
+    template <std::size_t Offset, std::size_t Count>
+    constexpr View<T, Count> subspan() const noexcept
+    {
+        static_assert(Offset + Count <= Extent, "subspan out of range");
+        return View<T, Count>(data_ + Offset);
+    }
+
+private:
+    T *data_;
+};
+
+/* copies src into dst, converting the element type, e.g. double data into a
+ * single precision solver; sizes are checked at compile time */
+template <class T, class U, std::size_t Extent>
+inline void assign(View<T, Extent> dst, View<U, Extent> src) noexcept
+{
+    std::transform(src.begin(), src.end(), dst.begin(), [](const U &v) { return static_cast<T>(v); });
+}
+
+template <class T, class U, std::size_t Extent>
+inline void assign(View<T, Extent> dst, const U (&src)[Extent]) noexcept
+{
+    assign(dst, View<const U, Extent>(src));
+}
+
+
+/* SOLVER ---------------------------------------------------------------*/
+/* N stages of NX variables and NP runtime parameters each, NXINIT initial and
+ * NXFINAL final conditions; the defaults are those the solver was generated
+ * with, any other instantiation does not compile. */
+template <std::size_t N = 61, std::size_t NX = 24, std::size_t NP = 41, std::size_t NXINIT = 16, std::size_t NXFINAL = 11>
+class Solver
+{
+    static_assert(sizeof(FORCESNLPsolver_output) == N * NX * sizeof(Float), "N and NX must match FORCESNLPsolver_output");
+    static_assert(sizeof(FORCESNLPsolver_params::x0) == N * NX * sizeof(Float), "N and NX must match FORCESNLPsolver_params::x0");
+    static_assert(sizeof(FORCESNLPsolver_params::xinit) == NXINIT * sizeof(Float), "NXINIT must match FORCESNLPsolver_params::xinit");
+    static_assert(sizeof(FORCESNLPsolver_params::xfinal) == NXFINAL * sizeof(Float), "NXFINAL must match FORCESNLPsolver_params::xfinal");
+    static_assert(sizeof(FORCESNLPsolver_params::all_parameters) == N * NP * sizeof(Float), "N and NP must match FORCESNLPsolver_params::all_parameters");
+
+public:
+    static constexpr std::size_t stages = N;
+    static constexpr std::size_t nx = NX;
+    static constexpr std::size_t np = NP;
+    static constexpr std::size_t nxinit = NXINIT;
+    static constexpr std::size_t nxfinal = NXFINAL;
+    static constexpr std::size_t nvars = N * NX;
+    static constexpr std::size_t nparams = N * NP;
+
+    using StageVars = View<Float, NX>;
+    using ConstStageVars = View<const Float, NX>;
+    using StageParams = View<Float, NP>;
+
+    /* heap context aligned to FORCESNLPsolver_ALIGNMENT; throws std::bad_alloc */
+    explicit Solver(FORCESNLPsolver_extfunc extfunc = &FORCESNLPsolver_casadi2forces)
+        : ctx_(FORCESNLPsolver_create(extfunc))
+    {
+        if( ctx_ == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~Solver()
+    {
+        if( ctx_ != nullptr )
+        {
+            FORCESNLPsolver_destroy(ctx_);
+        }
+    }
+
+    /* a moved-from solver may only be destroyed or assigned to */
+    Solver(Solver &&other) noexcept : ctx_(std::exchange(other.ctx_, nullptr)) {}
+
+    Solver &operator=(Solver &&other) noexcept
+    {
+        std::swap(ctx_, other.ctx_);
+        return *this;
+    }
+
+    Solver(const Solver &) = delete;
+    Solver &operator=(const Solver &) = delete;
+
+    /* the C context, for the functions of FORCESNLPsolver_context.h */
+    FORCESNLPsolver_context *get() noexcept { return ctx_; }
+    const FORCESNLPsolver_context *get() const noexcept { return ctx_; }
+
+    /* parameters of the next solve */
+    View<Float, N * NX> x0() noexcept { return View<Float, N * NX>(ctx_->params.x0); }
+    View<Float, NXINIT> xinit() noexcept { return View<Float, NXINIT>(ctx_->params.xinit); }
+    View<Float, NXFINAL> xfinal() noexcept { return View<Float, NXFINAL>(ctx_->params.xfinal); }
+    View<Float, N * NP> all_parameters() noexcept { return View<Float, N * NP>(ctx_->params.all_parameters); }
+
+    /* initial guess and runtime parameters of stage s (0..N-1), unchecked */
+    StageVars x0(std::size_t s) noexcept { return StageVars(ctx_->params.x0 + s * NX); }
+    StageParams stage_params(std::size_t s) noexcept { return StageParams(ctx_->params.all_parameters + s * NP); }
+
+    template <std::size_t S>
+    StageParams stage_params() noexcept
+    {
+        static_assert(S < N, "stage out of range");
+        return stage_params(S);
+    }
+
+    /* result of the last solve, stacked like x0, and stage s of it */
+    View<const Float, N * NX> solution() const noexcept { return View<const Float, N * NX>(output()); }
+    ConstStageVars stage(std::size_t s) const noexcept { return ConstStageVars(output() + s * NX); }
+
+    template <std::size_t S>
+    ConstStageVars stage() const noexcept
+    {
+        static_assert(S < N, "stage out of range");
+        return stage(S);
+    }
+
+    /* f(s, stage(s)) for s = 0..N-1, unrolled */
+    template <class F>
+    void for_each_stage(F &&f) const
+    {
+        for_each_stage(std::forward<F>(f), std::make_index_sequence<N>());
+    }
+
+    /* x0 = solution() */
+    void warm_start_from_solution() noexcept
+    {
+        std::copy_n(output(), N * NX, ctx_->params.x0);
+    }
+
+    /* options of the following solves, see FORCESNLPsolver_context.h */
+    void set_warmstart(solver_int32_default mode) noexcept { ctx_->warmstart = mode; }
+    void set_time_limit(Float seconds) noexcept { FORCESNLPsolver_set_time_limit(ctx_, seconds); }
+    void set_settings(const FORCESNLPsolver_settings &settings) noexcept { FORCESNLPsolver_set_settings(ctx_, &settings); }
+    void set_log(FORCESNLPsolver_logfunc func, void *userdata) noexcept { FORCESNLPsolver_set_log(ctx_, func, userdata); }
+    void set_print(FILE *fs) noexcept { ctx_->fs = fs; }
+
+    /* returns the exitflag, examine it before using the result! */
+    solver_int32_default solve() noexcept { return FORCESNLPsolver_solve_ctx(ctx_); }
+
+    solver_int32_default exitflag() const noexcept { return ctx_->exitflag; }
+    const FORCESNLPsolver_info &info() const noexcept { return ctx_->info; }
+
+private:
+    const Float *output() const noexcept { return reinterpret_cast<const Float *>(&ctx_->output); }
+
+    template <class F, std::size_t... S>
+    void for_each_stage(F &&f, std::index_sequence<S...>) const
+    {
+        (f(S, stage<S>()), ...);
+    }
+
+    FORCESNLPsolver_context *ctx_;
+};
+
+} /* namespace FORCESNLPsolver */
+
+#endif
@@ -0,0 +1,708 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Reentrant solver context on top of FORCESNLPsolver_solve.
+
+All data belonging to one solve (parameters, outputs, info, exitflag, print
+stream and external function pointer) lives in a caller-owned context, so
+several contexts can be driven from different threads of one process.
+
+*/
+
+#ifndef __FORCESNLPsolver_CONTEXT_H__
+#define __FORCESNLPsolver_CONTEXT_H__
+
+#include "FORCESNLPsolver.h"
+
+/* THREAD SAFETY --------------------------------------------------------*/
+/* The generated solver keeps its iterates in static storage. Unless the
+ * solver was generated with thread-safe storage (define
+ * FORCESNLPsolver_THREADSAFE_STORAGE in that case), FORCESNLPsolver_solve_ctx
+ * serializes the call into the solver core with a process-wide lock; the
+ * per-context copies in and out still run concurrently.
+ * Runtime settings (FORCESNLPsolver_build.py --runtime-settings) are handed to
+ * the core through process-wide state, so such a build always takes the lock.
+ * The time limit, profiling and tracing keep their state per call; only in an
+ * OpenMP build, whose evaluations run on other threads, do they take the lock.
+ * A solver generated with codeoptions.parallel and built with OpenMP (see
+ * FORCESNLPsolver_build.py --openmp) calls extfunc for several stages at
+ * once; the external function must then be reentrant. */
+
+
+/* WARM START -----------------------------------------------------------*/
+/* initial guess is params.x0 as given */
+#define FORCESNLPsolver_WARMSTART_OFF    (0)
+
+/* initial guess is the last optimal solution of the context */
+#define FORCESNLPsolver_WARMSTART_REUSE  (1)
+
+/* same, shifted forward by one stage (receding horizon), last stage repeated */
+#define FORCESNLPsolver_WARMSTART_SHIFT  (2)
+
+/* initial guess is the optimal solution in the cache of the context whose
+ * parameters are nearest to params, else as FORCESNLPsolver_WARMSTART_REUSE */
+#define FORCESNLPsolver_WARMSTART_NEAREST (3)
+
+
+/* RETURN CODES ---------------------------------------------------------*/
+/* time limit of the context reached; output holds the iterate the solver
+ * stopped at, check info.res_eq and info.res_ineq before using it */
+#define FORCESNLPsolver_TIMELIMIT_REACHED (-20)
+
+/* batch solve skipped by the cancel function of its FORCESNLPsolver_batch_control;
+ * its output is not written */
+#define FORCESNLPsolver_CANCELLED (-21)
+
+
+/* LOG SINK -------------------------------------------------------------*/
+/* receives the solver printout of one solve, possibly in several consecutive
+ * pieces; text is not NUL-terminated */
+typedef void (*FORCESNLPsolver_logfunc)(void *userdata, const char *text, size_t len);
+
+
+/* PROFILE --------------------------------------------------------------*/
+/* Cumulative timings of the solves of a context, in seconds of wall clock.
+ * The core does not time its phases separately; KKT assembly, factorization,
+ * line search, second order corrections and filter together make up coretime.
+ * evals counts every evaluation of a stage, line search and second order
+ * corrections included, so evals[s] / iterations above one shows their share. */
+typedef struct FORCESNLPsolver_profile
+{
+    /* number of solves and their total number of iterations */
+    solver_int64_default nsolves;
+    solver_int64_default iterations;
+
+    /* time of the solves, measured around the core */
+    double solvetime;
+
+    /* time spent in external functions (CasADi model), and the rest */
+    double fevalstime;
+    double coretime;
+
+    /* external function calls and their time by stage */
+    solver_int64_default evals[61];
+    double evaltime[61];
+
+} FORCESNLPsolver_profile;
+
+
+/* TRACE ----------------------------------------------------------------*/
+/* sweeps kept in a trace, the oldest are overwritten */
+#define FORCESNLPsolver_TRACE_SIZE (128)
+
+/* One entry per sweep of the core over the 61 stages, i.e. per iterate and
+ * per line search trial point. A sweep starts with a cost evaluation of stage
+ * 0 and is recorded once every stage has evaluated its cost for it;
+ * evaluations of derivatives alone do not count. dobj, rdgap, mu and the
+ * residuals of the iterations stay inside the core; info has them for the
+ * last iterate. */
+typedef struct FORCESNLPsolver_trace_entry
+{
+    /* number of the sweep in the solve, from 0 */
+    solver_int32_default sweep;
+
+    /* objective of the evaluated point, sum of the 61 stage costs */
+    FORCESNLPsolver_float pobj;
+
+    /* seconds from the start of the solve to the last stage of the sweep */
+    double time;
+
+} FORCESNLPsolver_trace_entry;
+
+/* trace of the last solve: the k-th recorded sweep is
+ * entries[k % FORCESNLPsolver_TRACE_SIZE], the last min(count,
+ * FORCESNLPsolver_TRACE_SIZE) are kept; a sweep some stage did not finish
+ * is left out, so entries[k].sweep may skip numbers */
+typedef struct FORCESNLPsolver_trace
+{
+    FORCESNLPsolver_trace_entry entries[FORCESNLPsolver_TRACE_SIZE];
+
+    /* sweeps of the last solve */
+    solver_int32_default count;
+
+} FORCESNLPsolver_trace;
+
+
+/* LAZY DERIVATIVES -----------------------------------------------------*/
+/* outputs of one external function call, as passed in needed below */
+#define FORCESNLPsolver_NEED_F       (0x01)
+#define FORCESNLPsolver_NEED_NABLA_F (0x02)
+#define FORCESNLPsolver_NEED_C       (0x04)
+#define FORCESNLPsolver_NEED_NABLA_C (0x08)
+#define FORCESNLPsolver_NEED_H       (0x10)
+#define FORCESNLPsolver_NEED_NABLA_H (0x20)
+#define FORCESNLPsolver_NEED_HESS    (0x40)
+
+/* external functions that only compute the outputs set in needed; the
+ * pointers of the others are NULL */
+typedef void (*FORCESNLPsolver_extfunc_needed)(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage, solver_int32_unsigned needed);
+
+/* When the core asks for the derivatives of a stage, the Jacobians nabla_c
+ * and nabla_h, and the Hessian, can be taken from an earlier evaluation of
+ * the same stage in the same solve instead. Values, nabla_f and the residuals
+ * of the core stay exact; a reused Jacobian or Hessian only changes the steps,
+ * so convergence may take more iterations. */
+typedef struct FORCESNLPsolver_lazy_options
+{
+    /* floats the model writes to nabla_c, nabla_h and hess of one stage, for the
+     * stage with the most; an output of size 0 is evaluated every time */
+    solver_int32_default nabla_c_size;
+    solver_int32_default nabla_h_size;
+    solver_int32_default hess_size;
+
+    /* reuse the Jacobians of a stage while none of its 24 variables has moved
+     * more than jacobian_tol from where they were evaluated; 0: never */
+    FORCESNLPsolver_float jacobian_tol;
+
+    /* same for the Hessian of the Lagrangian, which also depends on the
+     * multipliers: it is reused only while the first y_size values of y and
+     * l_size values of l of the stage are within hessian_tol as well; 0: never */
+    FORCESNLPsolver_float hessian_tol;
+
+    /* multipliers the model reads from y and l of one stage, for the stage with
+     * the most; with 0 that multiplier is not compared, which makes the reuse a
+     * deliberate approximation like freeze_after */
+    solver_int32_default y_size;
+    solver_int32_default l_size;
+
+    /* from evaluation freeze_after + 1 of a stage in a solve on, keep its last
+     * Hessian whatever the step; 0: never frozen */
+    solver_int32_default freeze_after;
+
+    /* model taking the needed mask; NULL calls the extfunc of the context with
+     * NULL for the outputs not needed, which CasADi generated code skips */
+    FORCESNLPsolver_extfunc_needed func;
+
+} FORCESNLPsolver_lazy_options;
+
+/* derivatives kept per stage for the solves of one context at a time, see
+ * FORCESNLPsolver_lazy_create */
+typedef struct FORCESNLPsolver_lazy FORCESNLPsolver_lazy;
+
+typedef struct FORCESNLPsolver_lazy_stats
+{
+    /* external function calls, and those that reused the Jacobians or the Hessian */
+    solver_int64_default evals;
+    solver_int64_default jacobians_reused;
+    solver_int64_default hessians_reused;
+
+} FORCESNLPsolver_lazy_stats;
+
+
+/* SENSITIVITIES --------------------------------------------------------*/
+/* perturbation of FORCESNLPsolver_sensitivity if none is given, in double and
+ * single precision: central differences err by about step^2 in truncation
+ * (one-sided ones by about step) and by the roundoff of the solution divided
+ * by the step */
+#define FORCESNLPsolver_SENSITIVITY_STEP        (1e-4)
+#define FORCESNLPsolver_SENSITIVITY_STEP_SINGLE (5e-3)
+
+/* the solves of FORCESNLPsolver_sensitivity stop at tolerances of at most
+ * this times the step, so that where they stop is small against where the
+ * perturbation moves the solution */
+#define FORCESNLPsolver_SENSITIVITY_TOL_RATIO (1e-3)
+
+/* return codes of FORCESNLPsolver_sensitivity: last solve not OPTIMAL (or
+ * ndir < 0), out of memory, nominal point not solved at the tightened
+ * tolerances */
+#define FORCESNLPsolver_SENSITIVITY_NOT_OPTIMAL    (-1)
+#define FORCESNLPsolver_SENSITIVITY_NO_MEMORY      (-2)
+#define FORCESNLPsolver_SENSITIVITY_NOMINAL_FAILED (-3)
+
+
+/* SOLVE CACHE ----------------------------------------------------------*/
+/* Results of earlier solves, keyed on xinit, xfinal, all_parameters and the
+ * settings other than printlevel; see FORCESNLPsolver_cache_create. Solves
+ * that reached the time limit are not stored, and solves of a context with a
+ * time limit or derivative reuse (FORCESNLPsolver_set_lazy) neither look up
+ * nor store. One cache can be shared by the contexts of several threads. */
+typedef struct FORCESNLPsolver_cache FORCESNLPsolver_cache;
+
+typedef struct FORCESNLPsolver_cache_stats
+{
+    /* solves answered from the cache, and solved */
+    solver_int64_default hits;
+    solver_int64_default misses;
+
+    /* misses warm started from a cached solution (FORCESNLPsolver_WARMSTART_NEAREST) */
+    solver_int64_default seeded;
+
+    /* entries dropped to make room, least recently used first */
+    solver_int64_default evictions;
+
+    /* entries stored, and room for */
+    solver_int32_default entries;
+    solver_int32_default capacity;
+
+} FORCESNLPsolver_cache_stats;
+
+
+/* WORKSPACE ------------------------------------------------------------*/
+/* contexts start on a cache line of their own, see FORCESNLPsolver_create_in */
+#define FORCESNLPsolver_ALIGNMENT (64)
+
+
+/* DIMENSIONS -----------------------------------------------------------*/
+/* The horizon and the stage sizes are fixed when the solver is generated;
+ * a solver of another horizon is a library of its own, with its own
+ * dimensions. Wrappers that read them from FORCESNLPsolver_get_dims serve
+ * any of them, and FORCESNLPsolver_resample_stages carries stage vectors
+ * (x0, all_parameters, a solution) from the horizon of one to another. */
+typedef struct FORCESNLPsolver_dims
+{
+    /* stages, and variables and runtime parameters of each */
+    solver_int32_default nstages;
+    solver_int32_default nvar;
+    solver_int32_default npar;
+
+    /* initial and final conditions */
+    solver_int32_default nxinit;
+    solver_int32_default nxfinal;
+
+} FORCESNLPsolver_dims;
+
+
+/* BATCH CONTROL --------------------------------------------------------*/
+/* called by the batch threads, possibly at the same time, before solve k
+ * starts; nonzero skips it. A solve that has started runs to the end. */
+typedef solver_int32_default (*FORCESNLPsolver_cancelfunc)(void *userdata, solver_int32_default k);
+
+typedef struct FORCESNLPsolver_batch_control
+{
+    /* NULL: no solve is skipped */
+    FORCESNLPsolver_cancelfunc cancel;
+    void *canceluser;
+
+    /* nonzero: batch thread i runs on the i-th processor the process may use
+     * only (Linux and Windows), so that the memory it touches first, including
+     * the core workspace of a thread-safe core, lies on the NUMA node of that
+     * processor. The calling thread gets its affinity back afterwards. */
+    solver_int32_default pin;
+
+} FORCESNLPsolver_batch_control;
+
+
+/* BATCH BACKEND --------------------------------------------------------*/
+/* Solves a whole batch of FORCESNLPsolver_solve_batch_lanes elsewhere, e.g. on
+ * a GPU with one thread block per problem: params, outputs, infos and
+ * exitflags as there (infos never NULL), all n problems in one call, so the data crosses to the
+ * device once per batch. Returns the number of solves that ended OPTIMAL, or
+ * a negative number without touching the outputs if it cannot take the batch;
+ * the host threads solve it then. */
+typedef solver_int32_default (*FORCESNLPsolver_lanesfunc)(void *userdata, const FORCESNLPsolver_float *params, FORCESNLPsolver_float *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n);
+
+typedef struct FORCESNLPsolver_batch_backend
+{
+    /* for messages, e.g. "cuda" */
+    const char *name;
+
+    FORCESNLPsolver_lanesfunc solve_lanes;
+    void *userdata;
+
+    /* smaller batches stay on the host, where they finish before a device
+     * launch and transfer would pay off */
+    solver_int32_default minbatch;
+
+} FORCESNLPsolver_batch_backend;
+
+
+/* COARSE TO FINE -------------------------------------------------------*/
+/* Solves the problem decimated to the nstages of a FORCESNLPsolver_coarse,
+ * i.e. a solver generated for that horizon over the same time span (its model
+ * stepping over the longer stage). params holds x0 (nstages * 24 values), xinit,
+ * xfinal and all_parameters (nstages * 41 values) back to back, output receives
+ * nstages * 24 values; returns the exitflag of the coarse solver. */
+typedef solver_int32_default (*FORCESNLPsolver_coarsefunc)(void *userdata, const FORCESNLPsolver_float *params, FORCESNLPsolver_float *output);
+
+typedef struct FORCESNLPsolver_coarse
+{
+    /* stages of the coarse solver, at least 2; with 16, every 4th of the 61 */
+    solver_int32_default nstages;
+
+    FORCESNLPsolver_coarsefunc solve;
+    void *userdata;
+
+    /* 41 flags, one per stage parameter: nonzero ones are interpolated in stage
+     * time, which suits samples of a signal over the horizon (references,
+     * weights, per-stage bounds); the others hold the value of the fine stage
+     * nearest in time, and those tied to the stage grid (stage length, stage
+     * time) must be set by solve for the coarse grid. NULL: all interpolated,
+     * for all_parameters without such entries. */
+    const solver_int8_default *interpolate;
+
+} FORCESNLPsolver_coarse;
+
+
+/* METRICS --------------------------------------------------------------*/
+/* Process-wide counters of all solves of the library, for monitoring: each
+ * solve adds to them with a few relaxed atomic increments and takes no lock.
+ * FORCESNLPsolver_get_metrics copies them, FORCESNLPsolver_metrics_export
+ * writes them in the Prometheus text format. Rates (warm starts per solve,
+ * cache hits per lookup) are left to the scraper, as usual for counters. */
+
+/* indices of FORCESNLPsolver_metrics.solves */
+#define FORCESNLPsolver_METRICS_OPTIMAL             (0)
+#define FORCESNLPsolver_METRICS_MAXITREACHED        (1)
+#define FORCESNLPsolver_METRICS_FACTORIZATION_ERROR (2)
+#define FORCESNLPsolver_METRICS_BADFUNCEVAL         (3)
+#define FORCESNLPsolver_METRICS_NOPROGRESS          (4)
+#define FORCESNLPsolver_METRICS_TIMELIMIT_REACHED   (5)
+#define FORCESNLPsolver_METRICS_OTHER               (6)
+#define FORCESNLPsolver_METRICS_NEXITFLAGS          (7)
+
+/* upper bounds of the histogram buckets: iterations, and seconds of
+ * info.solvetime and info.fevalstime */
+#define FORCESNLPsolver_METRICS_NITERATIONS (8)
+#define FORCESNLPsolver_METRICS_ITERATIONS  {5, 10, 20, 50, 100, 200, 500, 1000}
+#define FORCESNLPsolver_METRICS_NSECONDS    (16)
+#define FORCESNLPsolver_METRICS_SECONDS     {1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1, 2.5, 5, 10}
+
+typedef struct FORCESNLPsolver_metrics
+{
+    /* solves of the core by exitflag, answers from a solve cache not included */
+    solver_int64_default solves[FORCESNLPsolver_METRICS_NEXITFLAGS];
+
+    /* the same solves by iterations, solvetime and fevalstime: bucket k counts
+     * the values above bound k-1 up to bound k, the last bucket those above
+     * all bounds */
+    solver_int64_default iterations[FORCESNLPsolver_METRICS_NITERATIONS + 1];
+    solver_int64_default solvetime[FORCESNLPsolver_METRICS_NSECONDS + 1];
+    solver_int64_default fevalstime[FORCESNLPsolver_METRICS_NSECONDS + 1];
+
+    /* sums of the same, in iterations and seconds */
+    solver_int64_default iterations_sum;
+    double solvetime_sum;
+    double fevalstime_sum;
+
+    /* solves of a context started from a stored or cached solution */
+    solver_int64_default warmstarts;
+
+    /* lookups in a solve cache answered from it, and not */
+    solver_int64_default cache_hits;
+    solver_int64_default cache_misses;
+
+} FORCESNLPsolver_metrics;
+
+
+/* ASYNCHRONOUS SOLVES --------------------------------------------------*/
+/* worker threads that solve submitted contexts in the background, oldest first */
+typedef struct FORCESNLPsolver_pool FORCESNLPsolver_pool;
+struct FORCESNLPsolver_context;
+
+/* called on the pool thread once the solve of ctx has finished, before
+ * FORCESNLPsolver_poll and FORCESNLPsolver_wait report it */
+typedef void (*FORCESNLPsolver_donefunc)(void *userdata, struct FORCESNLPsolver_context *ctx);
+
+
+/* SOLVER CONTEXT -------------------------------------------------------*/
+/* the leading members are mirrored by FORCESNLPsolver_py.py - keep them first */
+typedef struct FORCESNLPsolver_context
+{
+    /* parameters of the next solve */
+    FORCESNLPsolver_params params;
+
+    /* result of the last solve */
+    FORCESNLPsolver_output output;
+
+    /* diagnostic data of the last solve */
+    FORCESNLPsolver_info info;
+
+    /* exitflag of the last solve */
+    solver_int32_default exitflag;
+
+    /* external function evaluations (CasADi model) */
+    FORCESNLPsolver_extfunc extfunc;
+
+    /* stream for solver printing, NULL to print nothing */
+    FILE *fs;
+
+    /* warm start mode of the next solve, one of FORCESNLPsolver_WARMSTART_* */
+    solver_int32_default warmstart;
+
+    /* primal solution of the last solve that ended OPTIMAL, stacked like x0 */
+    FORCESNLPsolver_float warm_x[1464];
+
+    /* nonzero if warm_x holds a solution */
+    solver_int32_default warm_valid;
+
+    /* if set, solver printing goes to memory and then to logfunc instead of fs */
+    FORCESNLPsolver_logfunc logfunc;
+    void *loguser;
+
+    /* threads used inside one solve by an OpenMP build, 0 for the OpenMP default */
+    solver_int32_default nthreads;
+
+    /* tolerances of the next solve, see FORCESNLPsolver_RUNTIME_SETTINGS */
+    FORCESNLPsolver_settings settings;
+
+    /* wall clock budget of one solve in seconds, 0 for none */
+    FORCESNLPsolver_float timelimit;
+
+    /* accumulates timings of each solve if set, caller-owned */
+    FORCESNLPsolver_profile *profile;
+
+    /* sweeps of the last solve if set, caller-owned */
+    FORCESNLPsolver_trace *trace;
+
+    /* results of earlier solves if set, caller-owned */
+    FORCESNLPsolver_cache *cache;
+
+    /* state of a submitted solve, see FORCESNLPsolver_submit */
+    FORCESNLPsolver_pool *pool;
+    solver_int32_default pending;
+    FORCESNLPsolver_donefunc done;
+    void *doneuser;
+    struct FORCESNLPsolver_context *nextjob;
+
+    /* derivative reuse if set, caller-owned */
+    FORCESNLPsolver_lazy *lazy;
+
+} FORCESNLPsolver_context;
+
+
+/* CONTEXT FUNCTION DEFINITION ------------------------------------------*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* size in bytes of FORCESNLPsolver_float the library was built with */
+extern solver_int32_default FORCESNLPsolver_float_size(void);
+
+/* dimensions the library was generated with */
+extern void FORCESNLPsolver_get_dims(FORCESNLPsolver_dims *dims);
+
+/* nsrc stages of width values each at src onto ndst stages at dst, linear in
+ * stage time: stage j of dst sits at j * (nsrc - 1) / (ndst - 1) of src, so
+ * the first and the last stage are kept as they are. Returns 0, or -1 if a
+ * count is below 1. src and dst must not overlap. */
+extern solver_int32_default FORCESNLPsolver_resample_stages(const FORCESNLPsolver_float *src, solver_int32_default nsrc, FORCESNLPsolver_float *dst, solver_int32_default ndst, solver_int32_default width);
+
+/* initialize caller-provided context memory */
+extern void FORCESNLPsolver_init(FORCESNLPsolver_context *ctx, FORCESNLPsolver_extfunc extfunc);
+
+/* allocate and initialize a context on the heap, aligned to
+ * FORCESNLPsolver_ALIGNMENT; NULL if out of memory */
+extern FORCESNLPsolver_context *FORCESNLPsolver_create(FORCESNLPsolver_extfunc extfunc);
+
+/* release a context obtained from FORCESNLPsolver_create */
+extern void FORCESNLPsolver_destroy(FORCESNLPsolver_context *ctx);
+
+/* bytes of memory one context takes, a multiple of FORCESNLPsolver_ALIGNMENT:
+ * contexts placed at consecutive multiples of it in an aligned arena share no
+ * cache line. This is all the memory of a solve outside the core, whose own
+ * workspace is static storage of the generated library (one copy per thread
+ * with FORCESNLPsolver_THREADSAFE_STORAGE). */
+extern size_t FORCESNLPsolver_workspace_size(void);
+
+/* initialize a context in the caller's memory arena (e.g. huge pages), which
+ * must be aligned to FORCESNLPsolver_ALIGNMENT and hold at least
+ * FORCESNLPsolver_workspace_size() bytes. Returns the context at arena, or
+ * NULL if arena is not suitable. The context allocates nothing itself; it is
+ * gone with the arena, do not pass it to FORCESNLPsolver_destroy. */
+extern FORCESNLPsolver_context *FORCESNLPsolver_create_in(void *arena, size_t size, FORCESNLPsolver_extfunc extfunc);
+
+/* route solver printing to func (NULL: back to ctx->fs) */
+extern void FORCESNLPsolver_set_log(FORCESNLPsolver_context *ctx, FORCESNLPsolver_logfunc func, void *userdata);
+
+/* threads for each solve of ctx in an OpenMP build (FORCESNLPsolver_build.py --openmp),
+ * n <= 0 uses the OpenMP default (OMP_NUM_THREADS); no effect in other builds */
+extern void FORCESNLPsolver_set_num_threads(FORCESNLPsolver_context *ctx, solver_int32_default n);
+
+/* fill settings with the compiled-in defaults (FORCESNLPsolver_DEFAULT_*) */
+extern void FORCESNLPsolver_default_settings(FORCESNLPsolver_settings *settings);
+
+/* settings of the following solves of ctx, NULL for the defaults; effective
+ * only if the solver was built with FORCESNLPsolver_RUNTIME_SETTINGS */
+extern void FORCESNLPsolver_set_settings(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_settings *settings);
+
+/* wall clock budget of each solve of ctx in seconds, seconds <= 0 for none.
+ * Once it is used up, the next function evaluation returns NaN, the solver
+ * stops and FORCESNLPsolver_solve_ctx returns FORCESNLPsolver_TIMELIMIT_REACHED. */
+extern void FORCESNLPsolver_set_time_limit(FORCESNLPsolver_context *ctx, FORCESNLPsolver_float seconds);
+
+/* accumulate the timings of the following solves of ctx into profile, NULL
+ * to stop; profiling adds two clock reads per external function call */
+extern void FORCESNLPsolver_set_profile(FORCESNLPsolver_context *ctx, FORCESNLPsolver_profile *profile);
+
+/* zero all counters and timers of profile */
+extern void FORCESNLPsolver_reset_profile(FORCESNLPsolver_profile *profile);
+
+/* record the sweeps of each following solve of ctx in trace, NULL to stop;
+ * the stages of a sweep may be evaluated on several threads */
+extern void FORCESNLPsolver_set_trace(FORCESNLPsolver_context *ctx, FORCESNLPsolver_trace *trace);
+
+/* cache of at most bytes of memory (an entry takes about 32 kB in double
+ * precision), NULL if out of memory or bytes do not hold one entry */
+extern FORCESNLPsolver_cache *FORCESNLPsolver_cache_create(size_t bytes);
+
+/* release a cache; no context may use it any more */
+extern void FORCESNLPsolver_cache_destroy(FORCESNLPsolver_cache *cache);
+
+/* drop all entries and zero the counters */
+extern void FORCESNLPsolver_cache_clear(FORCESNLPsolver_cache *cache);
+
+/* counters and fill of cache */
+extern void FORCESNLPsolver_cache_get_stats(FORCESNLPsolver_cache *cache, FORCESNLPsolver_cache_stats *stats);
+
+/* look up each following solve of ctx in cache (NULL to stop) and store its
+ * result there. A solve whose xinit, xfinal, all_parameters and settings are
+ * all equal to those of an entry returns the stored output, info and exitflag
+ * without calling the solver; x0 is not part of the key. Such a hit leaves an
+ * empty trace and is not counted in the profile. Bypassed while ctx has a
+ * time limit or a derivative store. */
+extern void FORCESNLPsolver_set_cache(FORCESNLPsolver_context *ctx, FORCESNLPsolver_cache *cache);
+
+/* derivative store for the options (copied), NULL if out of memory or a size
+ * is negative */
+extern FORCESNLPsolver_lazy *FORCESNLPsolver_lazy_create(const FORCESNLPsolver_lazy_options *options);
+
+/* release a derivative store; no context may use it any more */
+extern void FORCESNLPsolver_lazy_destroy(FORCESNLPsolver_lazy *lazy);
+
+/* counters of all solves with lazy so far */
+extern void FORCESNLPsolver_lazy_get_stats(const FORCESNLPsolver_lazy *lazy, FORCESNLPsolver_lazy_stats *stats);
+
+/* reuse derivatives in the following solves of ctx as set up in lazy (NULL
+ * to stop); contexts solving at the same time need a store each */
+extern void FORCESNLPsolver_set_lazy(FORCESNLPsolver_context *ctx, FORCESNLPsolver_lazy *lazy);
+
+/* forget the stored warm start solution */
+extern void FORCESNLPsolver_reset_warmstart(FORCESNLPsolver_context *ctx);
+
+/* copy values into the runtime parameters of stage (0..60), 41 values */
+extern solver_int32_default FORCESNLPsolver_set_stage_params(FORCESNLPsolver_context *ctx, solver_int32_default stage, const FORCESNLPsolver_float *values);
+
+/* copy n blocks of len values into ctx->params.all_parameters, block j starts
+ * at index first + j*stride; values holds the blocks back to back. E.g. the
+ * same slice of every stage: first = offset in stage, stride = 41, n = 61.
+ * Returns 0, or -1 (nothing copied) if the blocks overlap or do not fit into
+ * all_parameters. */
+extern solver_int32_default FORCESNLPsolver_set_param_slice(FORCESNLPsolver_context *ctx, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default n, const FORCESNLPsolver_float *values);
+
+/* solve with ctx->params, results go to ctx->output and ctx->info;
+ * with ctx->warmstart set and a stored solution, params.x0 is overwritten
+ * with the warm start before the solve */
+/* examine exitflag before using the result! */
+extern solver_int32_default FORCESNLPsolver_solve_ctx(FORCESNLPsolver_context *ctx);
+
+/* FORCESNLPsolver_solve_ctx from the solution of a coarse solve: x0 and the
+ * entries of all_parameters flagged in coarse->interpolate are resampled onto
+ * coarse->nstages stages (see FORCESNLPsolver_resample_stages), the coarse
+ * problem is solved, and if it ended OPTIMAL its solution resampled onto the
+ * 61 stages replaces params.x0. The coarse stage only runs for solves that
+ * would start from params.x0, i.e. without a warm start stored in ctx and not
+ * seeded from the cache by FORCESNLPsolver_WARMSTART_NEAREST, and is skipped
+ * if out of memory. coarse_exitflag (may be NULL) receives the exitflag of the coarse
+ * solve, FORCESNLPsolver_CANCELLED if it did not run. Returns the exitflag of
+ * the full solve, or -1 without solving if coarse->nstages < 2. */
+extern solver_int32_default FORCESNLPsolver_solve_coarse_to_fine(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_coarse *coarse, solver_int32_default *coarse_exitflag);
+
+/* derivatives of the solution of the last solve of ctx along ndir directions
+ * of all_parameters: row k of dx (1464 values, stacked like x0) receives
+ * d output / d all_parameters times directions + k*2501. The last solve must
+ * have ended OPTIMAL and ctx->params still be those of that solve.
+ * Computed by finite differences of step (<= 0: FORCESNLPsolver_SENSITIVITY_STEP,
+ * or _STEP_SINGLE in single precision) with the settings of ctx but the
+ * tolerances tightened to FORCESNLPsolver_SENSITIVITY_TOL_RATIO * step. The
+ * nominal point is first solved again at these tolerances from the last
+ * solution; the differences are then central (onesided = 0: 2*ndir + 1 full
+ * solves in all) or forward against that nominal solution (onesided != 0:
+ * ndir + 1 solves, half the cost at a truncation error of step instead of
+ * step^2). All perturbed solves start from the nominal solution, on a pool of
+ * nthreads threads as in
+ * FORCESNLPsolver_solve_batch. The tolerances take effect only with
+ * FORCESNLPsolver_RUNTIME_SETTINGS; otherwise step must stay well above the
+ * compiled ones. Rows with a perturbed solve that did not end OPTIMAL are NaN.
+ * Returns the number of rows computed, or (nothing done)
+ * FORCESNLPsolver_SENSITIVITY_NOT_OPTIMAL, _NO_MEMORY or _NOMINAL_FAILED. */
+extern solver_int32_default FORCESNLPsolver_sensitivity(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_float *directions, solver_int32_default ndir, FORCESNLPsolver_float step, solver_int32_default onesided, FORCESNLPsolver_float *dx, solver_int32_default nthreads);
+
+/* FORCESNLPsolver_sensitivity contracted with a loss gradient: grad[k] =
+ * lossgrad' * (row k of dx), with lossgrad the gradient of the loss w.r.t.
+ * output (1464 values). Still finite differences, not an adjoint: the same
+ * 2*ndir + 1 solves (central) or ndir + 1 (onesided), so the full gradient
+ * w.r.t. all_parameters takes 2501 directions, i.e. 5003 or 2502 solves; it
+ * only saves storing dx. Return codes as there. */
+extern solver_int32_default FORCESNLPsolver_sensitivity_fd(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_float *lossgrad, const FORCESNLPsolver_float *directions, solver_int32_default ndir, FORCESNLPsolver_float step, solver_int32_default onesided, FORCESNLPsolver_float *grad, solver_int32_default nthreads);
+
+/* start nthreads worker threads (nthreads <= 0: one per processor), NULL if
+ * none can be started */
+extern FORCESNLPsolver_pool *FORCESNLPsolver_pool_create(solver_int32_default nthreads);
+
+/* finish all submitted solves, then stop the threads and release pool; the
+ * contexts submitted to it must be collected by poll or wait before */
+extern void FORCESNLPsolver_pool_destroy(FORCESNLPsolver_pool *pool);
+
+/* queue FORCESNLPsolver_solve_ctx(ctx) on pool and return at once; done
+ * (may be NULL) is called when it has finished. ctx must not be touched
+ * until FORCESNLPsolver_poll returns 1 or FORCESNLPsolver_wait returns, which
+ * is also required before ctx can be submitted again. Returns 0, or -1 if
+ * ctx is still submitted. */
+extern solver_int32_default FORCESNLPsolver_submit(FORCESNLPsolver_pool *pool, FORCESNLPsolver_context *ctx, FORCESNLPsolver_donefunc done, void *userdata);
+
+/* 1 if the submitted solve of ctx has finished (or none was submitted), 0 if
+ * it is still queued or running */
+extern solver_int32_default FORCESNLPsolver_poll(FORCESNLPsolver_context *ctx);
+
+/* block until the submitted solve of ctx has finished, returns its exitflag */
+extern solver_int32_default FORCESNLPsolver_wait(FORCESNLPsolver_context *ctx);
+
+/* solve n problems params[0..n-1] on a pool of nthreads threads (nthreads <= 0:
+ * one per processor), solve k writes outputs[k], infos[k] and exitflags[k];
+ * infos may be NULL if they are not needed. Solves are handed out one at a time, so long solves do not hold up the rest.
+ * Nothing is printed. Returns the number of solves that ended OPTIMAL. */
+extern solver_int32_default FORCESNLPsolver_solve_batch(FORCESNLPsolver_params *params, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc);
+
+/* FORCESNLPsolver_solve_batch with the cancellation and pinning of control
+ * (NULL: neither); cancelled solves get exitflag FORCESNLPsolver_CANCELLED and
+ * a zero info */
+extern solver_int32_default FORCESNLPsolver_solve_batch_control(FORCESNLPsolver_params *params, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc, const FORCESNLPsolver_batch_control *control);
+
+/* batch solve of n problems that share all parameters of tmpl except nblocks
+ * blocks of len values of all_parameters, laid out as in
+ * FORCESNLPsolver_set_param_slice. Solve k uses the len*nblocks values at
+ * overrides + k*len*nblocks, so only the overrides are stored per problem.
+ * Returns the number of solves that ended OPTIMAL, or -1 (nothing solved) if
+ * the blocks overlap or do not fit into all_parameters. */
+extern solver_int32_default FORCESNLPsolver_solve_batch_template(const FORCESNLPsolver_params *tmpl, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default nblocks, const FORCESNLPsolver_float *overrides, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc);
+
+/* FORCESNLPsolver_solve_batch_template with control, as FORCESNLPsolver_solve_batch_control */
+extern solver_int32_default FORCESNLPsolver_solve_batch_template_control(const FORCESNLPsolver_params *tmpl, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default nblocks, const FORCESNLPsolver_float *overrides, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc, const FORCESNLPsolver_batch_control *control);
+
+/* batch solve of n problems stored interleaved (structure of arrays): element j
+ * of the 3992 stacked parameters of problem k (x0, xinit, xfinal,
+ * all_parameters, as in FORCESNLPsolver_params) is params[j*n + k], element j
+ * of its 1464 outputs goes to outputs[j*n + k]; infos and exitflags as in
+ * FORCESNLPsolver_solve_batch, control as in FORCESNLPsolver_solve_batch_control
+ * (NULL: none). The generated core solves one problem at a time, so each lane
+ * is gathered for it and its output scattered back; data kept lane by lane,
+ * e.g. for vectorized candidate generation, needs no transposition by the caller.
+ * Returns the number of solves that ended OPTIMAL. */
+extern solver_int32_default FORCESNLPsolver_solve_batch_lanes(const FORCESNLPsolver_float *params, FORCESNLPsolver_float *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc, const FORCESNLPsolver_batch_control *control);
+
+/* hand the following FORCESNLPsolver_solve_batch_lanes calls of at least
+ * backend->minbatch problems to backend (copied), NULL to solve all on the
+ * host again. Batches with a cancel function in their control always run on
+ * the host, which checks it per solve. Not while batch solves are running. */
+extern void FORCESNLPsolver_set_batch_backend(const FORCESNLPsolver_batch_backend *backend);
+
+/* the backend set by FORCESNLPsolver_set_batch_backend, NULL if none */
+extern const FORCESNLPsolver_batch_backend *FORCESNLPsolver_get_batch_backend(void);
+
+/* copy of the process-wide counters; each is read atomically, while solves
+ * running meanwhile may be counted in some of them only */
+extern void FORCESNLPsolver_get_metrics(FORCESNLPsolver_metrics *metrics);
+
+/* zero the process-wide counters */
+extern void FORCESNLPsolver_reset_metrics(void);
+
+/* the counters in the Prometheus text exposition format, as snprintf: at most
+ * size bytes including the terminating NUL go to buf (may be NULL if size is
+ * 0), returns the length of the whole text */
+extern size_t FORCESNLPsolver_metrics_export(char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Binary files of recorded solves.
+
+A record file is a FORCESNLPsolver_record_header followed by fixed-size
+records of packed float64 values: the parameters, and for solved problems the
+output, info and exitflag. All values are float64 whatever the solver
+precision, in the byte order of the writing machine (see byteorder), so a file
+can be memory-mapped and its records used in place.
+
+*/
+
+#ifndef __FORCESNLPsolver_RECORD_H__
+#define __FORCESNLPsolver_RECORD_H__
+
+#include "FORCESNLPsolver.h"
+
+/* FILE FORMAT ----------------------------------------------------------*/
+#define FORCESNLPsolver_RECORD_MAGIC     "FNLPREC"
+#define FORCESNLPsolver_RECORD_VERSION   (1)
+
+/* written as 0x01020304; reads differently on a machine of the other byte order */
+#define FORCESNLPsolver_RECORD_BYTEORDER (0x01020304)
+
+/* number of info fields, in the order of FORCESNLPsolver_info */
+#define FORCESNLPsolver_RECORD_NINFO     (19)
+
+/* 64 bytes at the start of the file */
+typedef struct FORCESNLPsolver_record_header
+{
+    /* FORCESNLPsolver_RECORD_MAGIC, NUL-terminated */
+    char magic[8];
+
+    solver_int32_unsigned version;
+    solver_int32_unsigned byteorder;
+
+    /* bytes of this header and of one record */
+    solver_int32_unsigned header_size;
+    solver_int32_unsigned record_size;
+
+    /* dimensions: 1464, 16, 11, 2501, 1464, 19 */
+    solver_int32_unsigned n_x0;
+    solver_int32_unsigned n_xinit;
+    solver_int32_unsigned n_xfinal;
+    solver_int32_unsigned n_all_parameters;
+    solver_int32_unsigned n_output;
+    solver_int32_unsigned n_info;
+
+    solver_int32_unsigned reserved[4];
+
+} FORCESNLPsolver_record_header;
+
+/* one recorded solve */
+typedef struct FORCESNLPsolver_record
+{
+    /* parameters, stacked like FORCESNLPsolver_params */
+    double x0[1464];
+    double xinit[16];
+    double xfinal[11];
+    double all_parameters[2501];
+
+    /* result, stacked like FORCESNLPsolver_output; zero for problems recorded unsolved */
+    double output[1464];
+
+    /* FORCESNLPsolver_info fields in order, iteration counts included */
+    double info[19];
+
+    /* exitflag of the solve, 0 if unsolved */
+    double exitflag;
+
+} FORCESNLPsolver_record;
+
+
+/* WRITING --------------------------------------------------------------*/
+typedef struct FORCESNLPsolver_record_writer FORCESNLPsolver_record_writer;
+
+/* MAPPED FILE ----------------------------------------------------------*/
+typedef struct FORCESNLPsolver_record_file
+{
+    /* the records of the file, read only */
+    const FORCESNLPsolver_record *records;
+
+    /* number of complete records */
+    solver_int64_default count;
+
+    /* mapping, for FORCESNLPsolver_record_unmap */
+    void *base;
+    size_t size;
+    void *handle;
+
+} FORCESNLPsolver_record_file;
+
+
+/* RECORD FUNCTION DEFINITION -------------------------------------------*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* open path for appending records, creating it with a header if it does not
+ * exist; NULL if it cannot be opened or is not a record file of this layout */
+extern FORCESNLPsolver_record_writer *FORCESNLPsolver_record_open(const char *path);
+
+/* append one solve; output and info may be NULL for a problem without result.
+ * Returns 0, or -1 on a write error. */
+extern solver_int32_default FORCESNLPsolver_record_append(FORCESNLPsolver_record_writer *writer, const FORCESNLPsolver_params *params, const FORCESNLPsolver_output *output, const FORCESNLPsolver_info *info, solver_int32_default exitflag);
+
+/* append a record filled before, e.g. by FORCESNLPsolver_record_fill or read
+ * from another file. Returns 0, or -1 on a write error. */
+extern solver_int32_default FORCESNLPsolver_record_write(FORCESNLPsolver_record_writer *writer, const FORCESNLPsolver_record *record);
+
+/* fill record in memory like FORCESNLPsolver_record_append would write it */
+extern void FORCESNLPsolver_record_fill(FORCESNLPsolver_record *record, const FORCESNLPsolver_params *params, const FORCESNLPsolver_output *output, const FORCESNLPsolver_info *info, solver_int32_default exitflag);
+
+/* flush and close, returns 0 or -1 if not all records reached the file */
+extern solver_int32_default FORCESNLPsolver_record_close(FORCESNLPsolver_record_writer *writer);
+
+/* map path read-only into memory; returns 0, or -1 if it cannot be mapped or
+ * is not a record file of this layout and byte order */
+extern solver_int32_default FORCESNLPsolver_record_map(const char *path, FORCESNLPsolver_record_file *file);
+
+/* release a mapping of FORCESNLPsolver_record_map */
+extern void FORCESNLPsolver_record_unmap(FORCESNLPsolver_record_file *file);
+
+/* parameters of record converted to the solver precision */
+extern void FORCESNLPsolver_record_params(const FORCESNLPsolver_record *record, FORCESNLPsolver_params *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
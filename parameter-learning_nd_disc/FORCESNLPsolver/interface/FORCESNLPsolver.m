@@ -76,6 +76,7 @@
 %       0 - Timeout - maximum number of iterations reached
 %      -6 - NaN or INF occured during evaluation of functions and derivatives. Please check your initial guess.
 %      -7 - Method could not progress. Problem may be infeasible. Run FORCESdiagnostics on your problem to check for most common errors in the formulation.
+%     -20 - Time limit PARAMS.timelimit reached (see below)
 %    -100 - License error
 %
 %   [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver(PARAMS) returns 
@@ -90,4 +91,137 @@
 %       INFO.solvetime - Time needed for solve (wall clock time)
 %       INFO.fevalstime - Time needed for function evaluations (wall clock time)
 %
+%   PARAMS.warmstart (optional) replaces PARAMS.x0 by the last optimal
+%   solution of a previous call, if there is one:
+%       0 - no warm start (default)
+%       1 - initial guess is the last optimal solution
+%       2 - same, shifted forward by one stage (last stage repeated)
+%       3 - initial guess is the cached optimal solution whose parameters
+%           are nearest to PARAMS, else as 1 (see 'cache' below)
+%   The stored solution is discarded by "clear FORCESNLPsolver".
+%
+%   PARAMS.timelimit (optional) is a wall clock budget of the solve in
+%   seconds. When it is used up the solver stops at its next function
+%   evaluation with EXITFLAG -20; OUTPUT is the iterate it stopped at, check
+%   INFO.res_eq and INFO.res_ineq before using it.
+%
+%   PARAMS.settings (optional) is a structure with any of the fields
+%   acc_rdgap, acc_reseq, acc_resineq, acc_kktcompl (tolerances), fls_scale
+%   (line search), maxit (iterations) and max_soc_it (second order
+%   corrections); the settings not given keep their generated values. They
+%   take effect only if the solver was built with FORCESNLPsolver_build.py
+%   --runtime-settings. The field printlevel = 0 silences the solve in any
+%   build.
+%
+%   FORCESNLPsolver(PARAMS, NTHREADS) with a single problem runs the solve on
+%   NTHREADS threads if the solver was built with FORCESNLPsolver_build.py
+%   --openmp (default: OpenMP default); it is ignored otherwise.
+%
+%   [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver(PARAMS, NTHREADS) solves a batch
+%   of K problems if PARAMS.all_parameters is of size [2501 x K]:
+%       PARAMS.x0, PARAMS.xinit, PARAMS.xfinal - one column shared by all
+%                    problems or one column per problem
+%       NTHREADS   - number of threads (optional, default: one per processor)
+%       OUTPUT.x01..OUTPUT.x61 - matrices of size [24 x K]
+%       EXITFLAG   - row vector of size [1 x K]
+%       INFO.*     - row vectors of size [1 x K]
+%
+%   [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver('batch', PARAMS, FIRST, LEN,
+%   STRIDE, OVERRIDES, NTHREADS) solves one problem per column of OVERRIDES
+%   (size [LEN*NB x K]) with the single-column PARAMS shared by all problems,
+%   except for NB blocks of LEN elements of all_parameters, block j at
+%   FIRST + (j-1)*STRIDE. Only OVERRIDES is stored per problem. Outputs as
+%   in batch mode above.
+%
+%   PARAMS.packed (optional, nonzero) returns OUTPUT as one matrix of size
+%   [24 x 61] instead of the fields x01..x61, column s is stage s; OUTPUT(:)
+%   can be used as the next PARAMS.x0. In batch mode OUTPUT is [24 x 61 x K].
+%
+%   Handle mode keeps parameters and result arrays in the MEX file between
+%   calls, so repeated solves only pass what changed:
+%       FORCESNLPsolver('init', PARAMS) stores all of PARAMS (and the
+%                    warmstart, timelimit, settings and packed options)
+%       [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver('solve', NAME, VALUE, ...)
+%                    or FORCESNLPsolver('solve', UPDATES) overwrites the given
+%                    parameters (x0, xinit, xfinal, all_parameters, warmstart,
+%                    timelimit, settings)
+%                    and solves with the stored ones otherwise
+%       FORCESNLPsolver('update', FIRST, LEN, STRIDE, VALUES) overwrites
+%                    blocks of LEN elements of the stored all_parameters,
+%                    block j at FIRST + (j-1)*STRIDE, taken from VALUES in
+%                    order; e.g. the same slice of every stage with
+%                    STRIDE = 41 and VALUES of size [LEN x 61]
+%   The handle mode has its own warm start and stored parameters; single
+%   calls FORCESNLPsolver(PARAMS) in between solve on a separate context and
+%   leave them as they are.
+%
+%   FORCESNLPsolver('profile', 1) resets and starts collecting timings of the
+%   single solves, FORCESNLPsolver('profile', 0) stops; PROFILE =
+%   FORCESNLPsolver('profile') returns them (wall clock seconds, cumulative):
+%       PROFILE.nsolves, PROFILE.iterations - number of solves and iterations
+%       PROFILE.solvetime  - time of the solves
+%       PROFILE.fevalstime - time in the function evaluations (CasADi model)
+%       PROFILE.coretime   - the rest: KKT assembly, factorization, line
+%                            search, second order corrections and filter
+%       PROFILE.evals, PROFILE.evaltime - [61 x 1] evaluations and their time
+%                            by stage; line search steps evaluate again, so
+%                            evals / iterations above one shows their share
+%
+%   FORCESNLPsolver('trace', 1) records the sweeps of the core over the 61
+%   stages (one per iterate and per line search trial point) of each single
+%   solve, FORCESNLPsolver('trace', 0) stops; TRACE = FORCESNLPsolver('trace')
+%   returns those of the last solve as a matrix of size [K x 3], oldest first,
+%   with the columns sweep number (from 0), seconds since the start of the
+%   solve and objective of the evaluated point. The last 128 sweeps are kept.
+%
+%   DX = FORCESNLPsolver('sens', DIRECTIONS, STEP, NTHREADS, ONESIDED) returns the
+%   derivatives of the solution of the last single solve along the columns
+%   of DIRECTIONS (size [2501 x K]) of all_parameters, as a matrix of size
+%   [1464 x K] stacked like x0; LOSSGRAD' * DX is then the gradient of a loss
+%   w.r.t. the directions. The last solve must have ended with EXITFLAG 1.
+%   Computed by central differences of STEP (optional, default 1e-4, 5e-3 in
+%   single precision), two full solves per column and one to refine the
+%   solution, 2*K + 1 in all; with ONESIDED true (optional, default false),
+%   forward differences against the refined solution, K + 1 solves at a
+%   truncation error of STEP instead of STEP^2. The solution is first
+%   refined at tolerances of 1e-3 * STEP, and the perturbed solves start from
+%   it at the same tolerances, on NTHREADS threads (optional, default one per
+%   processor). The tolerances are only tightened in a build with runtime
+%   settings; otherwise keep STEP well above the compiled ones. Columns whose
+%   solves failed are NaN. A gradient w.r.t. all of all_parameters takes 2501
+%   columns.
+%
+%   ID = FORCESNLPsolver('submit', PARAMS) starts solving PARAMS (with the
+%   timelimit, settings and packed options) on solver threads, one per
+%   processor, and returns at once; there is no warm start from earlier
+%   solves and no printout. FORCESNLPsolver('poll', ID) is true once it has
+%   finished. [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver('wait', ID) waits
+%   for it and returns its results as for a single solve; ID is then free.
+%   At most 1024 solves can be submitted and not yet collected by 'wait'.
+%
+%   FORCESNLPsolver('cache', MB) keeps the results of the following single
+%   solves in a cache of at most MB megabytes (about 32 results per MB), the
+%   least recently used go first; FORCESNLPsolver('cache', 0) drops it. A
+%   solve whose xinit, xfinal, all_parameters and settings (but printlevel)
+%   equal those of a cached one returns the stored OUTPUT, EXITFLAG and INFO
+%   without solving; the trace is then empty and the profile does not count
+%   it. Solves with a PARAMS.timelimit bypass the cache. STATS =
+%   FORCESNLPsolver('cache') returns the fields hits, misses, seeded (misses
+%   warm started with PARAMS.warmstart = 3), evictions, entries and capacity.
+%
+%   METRICS = FORCESNLPsolver('metrics') returns the counters of all solves
+%   of the process (this MEX file, its solver threads and batches):
+%       METRICS.solves     - solves of the core by exitflag, fields OPTIMAL,
+%                            MAXITREACHED, FACTORIZATION_ERROR, BADFUNCEVAL,
+%                            NOPROGRESS, TIMELIMIT_REACHED and OTHER; cache
+%                            answers are not solves
+%       METRICS.iterations, METRICS.solvetime, METRICS.fevalstime - histograms
+%                            of the same solves, rows [upper bound, count],
+%                            Inf as the last bound
+%       METRICS.iterations_sum, METRICS.solvetime_sum, METRICS.fevalstime_sum
+%       METRICS.warmstarts - solves started from a stored or cached solution
+%       METRICS.cache_hits, METRICS.cache_misses - solve cache lookups
+%   TEXT = FORCESNLPsolver('metrics', 'text') returns them in the Prometheus
+%   text exposition format, FORCESNLPsolver('metrics', 'reset') zeros them.
+%
 % See also COPYING
@@ -0,0 +1,332 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Benchmark on a corpus of recorded problems.
+
+    FORCESNLPsolver_benchmark CORPUS [-n N] [-o RESULTS.csv] [-b BASELINE.csv] [-t TOL]
+
+Every problem of CORPUS is solved N times (default 10) cold, i.e. from the
+recorded x0, and N times warm, i.e. from the solution of the previous solve of
+the same problem. Reported per problem and mode are the median and the 99th
+percentile of the wall clock time per solve, the mean number of iterations, the
+share of the function evaluations in the solve time and the exitflags.
+
+-o writes these results as CSV, one line per problem and mode. -b reads such a
+file of an earlier run (e.g. of another generated solver version) and lists the
+problems whose median time grew by more than TOL (default 0.1, i.e. 10%) or
+that end OPTIMAL less often; the exit status is then 1.
+
+CORPUS is a record file (see FORCESNLPsolver_record.h), memory-mapped; only
+the parameters of its records are used.
+
+Built by FORCESNLPsolver_build.py --benchmark, or by hand against the solver
+and the model, e.g.
+    cc -O2 FORCESNLPsolver_benchmark.c -I../include -L../lib -lFORCESNLPsolver_withModel -o FORCESNLPsolver_benchmark
+
+*/
+
+/* clock_gettime */
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/FORCESNLPsolver.h"
+#include "../include/FORCESNLPsolver_context.h"
+#include "../include/FORCESNLPsolver_record.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+extern void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
+
+/* modes of solving each problem */
+#define BENCH_COLD (0)
+#define BENCH_WARM (1)
+static const char *modenames[2] = {"cold", "warm"};
+
+
+/* TIMER ----------------------------------------------------------------*/
+static double bench_seconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double) t.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1e-9 * (double) t.tv_nsec;
+#endif
+}
+
+
+/* RESULTS --------------------------------------------------------------*/
+/* summary of the N solves of one problem in one mode */
+typedef struct bench_result
+{
+    long problem;
+    int mode;
+    int nsolves;
+    double median;
+    double p99;
+    double iterations;
+    double fevalshare;
+    int noptimal;
+    int nmaxit;
+    int nfailed;
+
+} bench_result;
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* q-quantile of the n sorted values */
+static double quantile(const double *sorted, int n, double q)
+{
+    int k = (int) (q * n + 0.999999);
+    if( k < 1 )
+    {
+        k = 1;
+    }
+    return sorted[(k > n ? n : k) - 1];
+}
+
+/* solves record nsolves times in mode, times holds nsolves doubles of scratch */
+static void bench_problem(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_params *record, long problem, int mode, int nsolves, double *times, bench_result *res)
+{
+    double solvetime = 0.0, fevalstime = 0.0, iterations = 0.0, start;
+    solver_int32_default exitflag;
+    int i;
+
+    memset(res, 0, sizeof(bench_result));
+    res->problem = problem;
+    res->mode = mode;
+    res->nsolves = nsolves;
+
+    /* a warm run starts from the solution of an untimed cold solve */
+    FORCESNLPsolver_reset_warmstart(ctx);
+    ctx->warmstart = FORCESNLPsolver_WARMSTART_OFF;
+    if( mode == BENCH_WARM )
+    {
+        memcpy(&ctx->params, record, sizeof(FORCESNLPsolver_params));
+        FORCESNLPsolver_solve_ctx(ctx);
+        ctx->warmstart = FORCESNLPsolver_WARMSTART_REUSE;
+    }
+
+    for( i = 0; i < nsolves; i++ )
+    {
+        memcpy(&ctx->params, record, sizeof(FORCESNLPsolver_params));
+        start = bench_seconds();
+        exitflag = FORCESNLPsolver_solve_ctx(ctx);
+        times[i] = bench_seconds() - start;
+
+        iterations += ctx->info.it;
+        solvetime += ctx->info.solvetime;
+        fevalstime += ctx->info.fevalstime;
+        if( exitflag == FORCESNLPsolver_OPTIMAL )
+        {
+            res->noptimal++;
+        }
+        else if( exitflag == FORCESNLPsolver_MAXITREACHED )
+        {
+            res->nmaxit++;
+        }
+        else
+        {
+            res->nfailed++;
+        }
+    }
+
+    qsort(times, nsolves, sizeof(double), compare_doubles);
+    res->median = quantile(times, nsolves, 0.5);
+    res->p99 = quantile(times, nsolves, 0.99);
+    res->iterations = iterations / nsolves;
+    res->fevalshare = solvetime > 0 ? fevalstime / solvetime : 0.0;
+}
+
+static void write_header(FILE *f)
+{
+    fprintf(f, "problem,mode,solves,median_s,p99_s,iterations,fevals_share,optimal,maxit,failed\n");
+}
+
+static void write_result(FILE *f, const bench_result *res)
+{
+    fprintf(f, "%ld,%s,%d,%.9g,%.9g,%.6g,%.6g,%d,%d,%d\n", res->problem, modenames[res->mode], res->nsolves,
+            res->median, res->p99, res->iterations, res->fevalshare, res->noptimal, res->nmaxit, res->nfailed);
+}
+
+/* reads the results of an earlier run, returns their number (0 on error) and sets *results */
+static long read_results(const char *path, bench_result **results)
+{
+    FILE *f = fopen(path, "r");
+    char line[512], mode[16];
+    bench_result res, *all = NULL, *grown;
+    long n = 0, size = 0;
+
+    *results = NULL;
+    if( f == NULL )
+    {
+        return 0;
+    }
+    while( fgets(line, sizeof(line), f) != NULL )
+    {
+        memset(&res, 0, sizeof(res));
+        if( sscanf(line, "%ld,%15[^,],%d,%lf,%lf,%lf,%lf,%d,%d,%d", &res.problem, mode, &res.nsolves, &res.median, &res.p99,
+                   &res.iterations, &res.fevalshare, &res.noptimal, &res.nmaxit, &res.nfailed) != 10 )
+        {
+            continue;
+        }
+        res.mode = strcmp(mode, modenames[BENCH_WARM]) == 0 ? BENCH_WARM : BENCH_COLD;
+        if( n == size )
+        {
+            size = size > 0 ? 2 * size : 64;
+            grown = (bench_result *) realloc(all, size * sizeof(bench_result));
+            if( grown == NULL )
+            {
+                break;
+            }
+            all = grown;
+        }
+        all[n++] = res;
+    }
+    fclose(f);
+    *results = all;
+    return n;
+}
+
+
+/* MAIN -----------------------------------------------------------------*/
+static void usage(void)
+{
+    fprintf(stderr, "usage: FORCESNLPsolver_benchmark CORPUS [-n N] [-o RESULTS.csv] [-b BASELINE.csv] [-t TOL]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *corpus = NULL, *outpath = NULL, *basepath = NULL;
+    int nsolves = 10, mode, i, regressions = 0;
+    double tol = 0.1, *times;
+    long nbase = 0, k, j;
+    FORCESNLPsolver_record_file records;
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_context *ctx;
+    bench_result res, *base = NULL;
+    FILE *out = NULL;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( argv[i][0] != '-' )
+        {
+            corpus = argv[i];
+        }
+        else if( i + 1 >= argc )
+        {
+            usage();
+        }
+        else if( strcmp(argv[i], "-n") == 0 )
+        {
+            nsolves = atoi(argv[++i]);
+        }
+        else if( strcmp(argv[i], "-o") == 0 )
+        {
+            outpath = argv[++i];
+        }
+        else if( strcmp(argv[i], "-b") == 0 )
+        {
+            basepath = argv[++i];
+        }
+        else if( strcmp(argv[i], "-t") == 0 )
+        {
+            tol = atof(argv[++i]);
+        }
+        else
+        {
+            usage();
+        }
+    }
+    if( corpus == NULL || nsolves < 1 )
+    {
+        usage();
+    }
+
+    if( FORCESNLPsolver_record_map(corpus, &records) != 0 || records.count == 0 )
+    {
+        fprintf(stderr, "%s: not a record file or no records\n", corpus);
+        return 2;
+    }
+    if( basepath != NULL && (nbase = read_results(basepath, &base)) == 0 )
+    {
+        fprintf(stderr, "%s: no results found\n", basepath);
+        return 2;
+    }
+    if( outpath != NULL )
+    {
+        if( (out = fopen(outpath, "w")) == NULL )
+        {
+            fprintf(stderr, "%s: cannot write\n", outpath);
+            return 2;
+        }
+        write_header(out);
+    }
+    times = (double *) malloc(nsolves * sizeof(double));
+    ctx = FORCESNLPsolver_create(FORCESNLPsolver_casadi2forces);
+    if( times == NULL || ctx == NULL )
+    {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    printf("%8s %5s %12s %12s %8s %7s %8s %6s %7s\n", "problem", "mode", "median [ms]", "p99 [ms]", "iter", "fevals", "optimal", "maxit", "failed");
+    for( k = 0; k < records.count; k++ )
+    {
+        FORCESNLPsolver_record_params(&records.records[k], &params);
+        for( mode = BENCH_COLD; mode <= BENCH_WARM; mode++ )
+        {
+            bench_problem(ctx, &params, k, mode, nsolves, times, &res);
+            printf("%8ld %5s %12.3f %12.3f %8.1f %6.1f%% %8d %6d %7d\n", k, modenames[mode], 1e3 * res.median, 1e3 * res.p99,
+                   res.iterations, 100.0 * res.fevalshare, res.noptimal, res.nmaxit, res.nfailed);
+            if( out != NULL )
+            {
+                write_result(out, &res);
+            }
+            for( j = 0; j < nbase; j++ )
+            {
+                if( base[j].problem != k || base[j].mode != mode )
+                {
+                    continue;
+                }
+                if( res.median > (1.0 + tol) * base[j].median || res.noptimal * base[j].nsolves < base[j].noptimal * res.nsolves )
+                {
+                    printf("REGRESSION problem %ld %s: median %.3f ms (baseline %.3f ms), optimal %d/%d (baseline %d/%d)\n", k, modenames[mode],
+                           1e3 * res.median, 1e3 * base[j].median, res.noptimal, res.nsolves, base[j].noptimal, base[j].nsolves);
+                    regressions++;
+                }
+            }
+        }
+    }
+
+    if( out != NULL )
+    {
+        fclose(out);
+    }
+    FORCESNLPsolver_destroy(ctx);
+    free(times);
+    FORCESNLPsolver_record_unmap(&records);
+    free(base);
+    if( basepath != NULL )
+    {
+        printf("%d regression(s) against %s\n", regressions, basepath);
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -31,6 +31,8 @@ import distutils
 
 # determine source file
 sourcefile = os.path.join(os.getcwd(),"FORCESNLPsolver","src","FORCESNLPsolver"+".c")
+contextfile = os.path.join(os.getcwd(),"FORCESNLPsolver","interface","FORCESNLPsolver"+"_context.c")
+recordfile = os.path.join(os.getcwd(),"FORCESNLPsolver","interface","FORCESNLPsolver"+"_record.c")
 
 # determine lib file
 if sys.platform.startswith('win'):
@@ -44,19 +46,100 @@ if not os.path.exists(os.path.join(os.getcwd(),"FORCESNLPsolver","lib")):
 								
 
 				
+# OpenMP, for solvers generated with codeoptions.parallel: the stage-wise function
+# evaluations and factorizations of one solve then run on several threads.
+# Enable with "python FORCESNLPsolver_build.py --openmp" or FORCESNLPsolver_OPENMP=1,
+# the thread count is set by OMP_NUM_THREADS.
+openmp = '--openmp' in sys.argv or os.environ.get('FORCESNLPsolver_OPENMP', '0') == '1'
+
+# single precision (FORCESNLPsolver_float is float), with "--single" or FORCESNLPsolver_SINGLE=1;
+# the solver source and the model must have been generated for it as well
+single = '--single' in sys.argv or os.environ.get('FORCESNLPsolver_SINGLE', '0') == '1'
+macros = [('FORCESNLPsolver_SINGLE_PRECISION', None)] if single else []
+
+# tolerances taken from the solver context at run time (FORCESNLPsolver_set_settings) instead
+# of being compiled in, with "--runtime-settings" or FORCESNLPsolver_RUNTIME_SETTINGS=1
+if '--runtime-settings' in sys.argv or os.environ.get('FORCESNLPsolver_RUNTIME_SETTINGS', '0') == '1':
+	macros.append(('FORCESNLPsolver_RUNTIME_SETTINGS', None))
+
+# capacity of the filter of the line search, "--filter-size=N" (default 5000, one entry per
+# iteration); the static storage of the core shrinks with it
+for arg in sys.argv[1:]:
+	if arg.startswith('--filter-size='):
+		if not arg[len('--filter-size='):].isdigit() or int(arg[len('--filter-size='):]) < 1:
+			sys.exit('--filter-size needs a positive number of entries')
+		macros.append(('FORCESNLPsolver_MAX_FILTER_SIZE', arg[len('--filter-size='):]))
+
+# instruction set, "--isa=sse2|avx|avx2|avx512" (default avx). With "--isa-variants" the
+# solver libraries FORCESNLPsolver_sse2 ... FORCESNLPsolver_avx512 are built in addition;
+# FORCESNLPsolver_py.py loads the one for the best instruction set the CPU supports and
+# takes the external functions (CasADi model) from FORCESNLPsolver_withModel.
+isaflags = {'sse2':   (['-msse2'], []),
+            'avx':    (['-mavx'], ['/arch:AVX']),
+            'avx2':   (['-mavx2','-mfma'], ['/arch:AVX2']),
+            'avx512': (['-mavx512f','-mavx512dq','-mavx512vl','-mavx2','-mfma'], ['/arch:AVX512'])}
+isa = 'avx'
+for arg in sys.argv[1:]:
+	if arg.startswith('--isa='):
+		isa = arg[len('--isa='):]
+if isa not in isaflags:
+	sys.exit('unknown instruction set %s, use one of %s' % (isa, ', '.join(sorted(isaflags))))
+
 # compile into object file
 objdir = os.path.join(os.getcwd(),"FORCESNLPsolver","obj")
-if isinstance(c,distutils.unixccompiler.UnixCCompiler):
-	#objects = c.compile([sourcefile], output_dir=objdir, extra_preargs=['-O3','-fPIC','-fopenmp','-mavx'])
-	objects = c.compile([sourcefile], output_dir=objdir, extra_preargs=['-O3','-fPIC','-mavx'])
+linkargs = []
+unix = isinstance(c,distutils.unixccompiler.UnixCCompiler)
+if unix:
+	if openmp:
+		linkargs.append('-fopenmp')
 	if sys.platform.startswith('linux'):
-		c.set_libraries(['rt','gomp'])
-else:
-	objects = c.compile([sourcefile], output_dir=objdir)
+		c.set_libraries(['rt','gomp','pthread'])
+
+def compile_solver(isa, outdir):
+	if unix:
+		compileargs = ['-O3','-fPIC'] + isaflags[isa][0] + (['-fopenmp'] if openmp else [])
+	else:
+		compileargs = isaflags[isa][1] + (['/openmp'] if openmp else [])
+	return c.compile([sourcefile, contextfile, recordfile], output_dir=outdir, macros=macros, extra_preargs=compileargs)
+
+objects = compile_solver(isa, objdir)
 
 				
 # create libraries
 libdir = os.path.join(os.getcwd(),"FORCESNLPsolver","lib")
-exportsymbols = ["%s_solve" % "FORCESNLPsolver"]
+exportsymbols = ["%s_%s" % ("FORCESNLPsolver", fn) for fn in ["solve", "init", "create", "destroy", "workspace_size", "create_in", "solve_ctx", "solve_coarse_to_fine", "solve_batch", "set_log", "reset_warmstart", "set_stage_params", "set_param_slice", "solve_batch_template", "solve_batch_control", "solve_batch_template_control", "solve_batch_lanes", "set_batch_backend", "get_batch_backend", "get_metrics", "reset_metrics", "metrics_export", "float_size", "get_dims", "resample_stages", "set_num_threads", "default_settings", "set_settings", "set_time_limit", "set_profile", "reset_profile", "set_trace", "record_open", "record_append", "record_close", "record_map", "record_unmap", "record_params", "record_fill", "record_write", "cache_create", "cache_destroy", "cache_clear", "cache_get_stats", "set_cache", "lazy_create", "lazy_destroy", "lazy_get_stats", "set_lazy", "sensitivity", "sensitivity_fd", "pool_create", "pool_destroy", "submit", "poll", "wait"]]
 c.create_static_lib(objects, "FORCESNLPsolver", output_dir=libdir)
-c.link_shared_lib(objects, "FORCESNLPsolver", output_dir=libdir, export_symbols=exportsymbols)
\ No newline at end of file
+c.link_shared_lib(objects, "FORCESNLPsolver", output_dir=libdir, export_symbols=exportsymbols, extra_preargs=linkargs)
+if '--isa-variants' in sys.argv:
+	for variant in ['sse2', 'avx', 'avx2', 'avx512']:
+		variantobjects = compile_solver(variant, os.path.join(objdir, variant))
+		c.link_shared_lib(variantobjects, "FORCESNLPsolver" + "_" + variant, output_dir=libdir, export_symbols=exportsymbols, extra_preargs=linkargs)
+
+
+# optional zero-copy Python extension, does not link against the solver
+import sysconfig
+pyextfile = os.path.join(os.getcwd(),"FORCESNLPsolver","interface","FORCESNLPsolver"+"_pyext.c")
+pyextname = "FORCESNLPsolver" + "_pyext" + (sysconfig.get_config_var('EXT_SUFFIX') or sysconfig.get_config_var('SO'))
+pyc = new_compiler()
+try:
+	if isinstance(pyc,distutils.unixccompiler.UnixCCompiler):
+		pyobjects = pyc.compile([pyextfile], output_dir=objdir, macros=macros, include_dirs=[sysconfig.get_paths()['include']], extra_preargs=['-O3','-fPIC'])
+		pyc.link_shared_object(pyobjects, pyextname, output_dir=libdir)
+	else:
+		pyobjects = pyc.compile([pyextfile], output_dir=objdir, macros=macros, include_dirs=[sysconfig.get_paths()['include']])
+		pyc.link_shared_object(pyobjects, pyextname, output_dir=libdir, library_dirs=[os.path.join(sys.exec_prefix,'libs')], export_symbols=["PyInit_" + "FORCESNLPsolver" + "_pyext"])
+except Exception as e:
+	print("FORCESNLPsolver_pyext not built (%s), FORCESNLPsolver_py falls back to ctypes" % e)
+
+# optional benchmark (FORCESNLPsolver_benchmark.c) with "--benchmark", linked against the
+# model library FORCESNLPsolver_withModel, which must be in the lib dir already
+if '--benchmark' in sys.argv:
+	benchfile = os.path.join(os.getcwd(),"FORCESNLPsolver","interface","FORCESNLPsolver"+"_benchmark.c")
+	benchobjects = c.compile([benchfile], output_dir=objdir, macros=macros, extra_preargs=['-O2'] if unix else [])
+	c.link_executable(benchobjects, "FORCESNLPsolver" + "_benchmark", output_dir=libdir, libraries=["FORCESNLPsolver" + "_withModel"], library_dirs=[libdir], extra_preargs=linkargs)
+
+# optional sweep runner (FORCESNLPsolver_sweep.c) with "--sweep", linked like the benchmark
+if '--sweep' in sys.argv:
+	sweepfile = os.path.join(os.getcwd(),"FORCESNLPsolver","interface","FORCESNLPsolver"+"_sweep.c")
+	sweepobjects = c.compile([sweepfile], output_dir=objdir, macros=macros, extra_preargs=['-O2'] if unix else [])
+	c.link_executable(sweepobjects, "FORCESNLPsolver" + "_sweep", output_dir=libdir, libraries=["FORCESNLPsolver" + "_withModel"] + ([] if unix else ["ws2_32"]), library_dirs=[libdir], extra_preargs=linkargs)
\ No newline at end of file
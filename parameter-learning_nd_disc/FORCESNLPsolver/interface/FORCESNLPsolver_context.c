@@ -0,0 +1,2295 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Reentrant solver context, see ../include/FORCESNLPsolver_context.h
+
+*/
+
+/* open_memstream */
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+/* sched_setaffinity */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/FORCESNLPsolver_context.h"
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+
+/* THREADS AND LOCKS ----------------------------------------------------*/
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+typedef SRWLOCK FORCESNLPsolver_mutex;
+typedef HANDLE FORCESNLPsolver_thread;
+#define FORCESNLPsolver_MUTEX_INIT SRWLOCK_INIT
+#define FORCESNLPsolver_mutex_init(m)   InitializeSRWLock(m)
+#define FORCESNLPsolver_mutex_lock(m)   AcquireSRWLockExclusive(m)
+#define FORCESNLPsolver_mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#define FORCESNLPsolver_mutex_free(m)
+#define FORCESNLPsolver_THREAD_LOCAL __declspec(thread)
+#define FORCESNLPsolver_atomic_add(p, v)   InterlockedExchangeAdd64((volatile LONG64 *) (p), (LONG64) (v))
+#define FORCESNLPsolver_atomic_load(p)     InterlockedCompareExchange64((volatile LONG64 *) (p), 0, 0)
+#define FORCESNLPsolver_atomic_store(p, v) InterlockedExchange64((volatile LONG64 *) (p), (LONG64) (v))
+typedef CONDITION_VARIABLE FORCESNLPsolver_cond;
+#define FORCESNLPsolver_cond_init(c)      InitializeConditionVariable(c)
+#define FORCESNLPsolver_cond_wait(c, m)   SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define FORCESNLPsolver_cond_broadcast(c) WakeAllConditionVariable(c)
+#define FORCESNLPsolver_cond_free(c)
+#define FORCESNLPsolver_THREAD_FUNC(name) static DWORD WINAPI name(LPVOID arg)
+#define FORCESNLPsolver_THREAD_RETURN return 0
+typedef LPTHREAD_START_ROUTINE FORCESNLPsolver_thread_func;
+
+static int FORCESNLPsolver_thread_start(FORCESNLPsolver_thread *t, FORCESNLPsolver_thread_func func, void *arg)
+{
+    *t = CreateThread(NULL, 0, func, arg, 0, NULL);
+    return *t != NULL ? 0 : -1;
+}
+
+static void FORCESNLPsolver_thread_join(FORCESNLPsolver_thread t)
+{
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static solver_int32_default FORCESNLPsolver_num_processors(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (solver_int32_default) si.dwNumberOfProcessors;
+}
+
+/* runs the calling thread on the index-th processor the process may use only,
+   its affinity before goes to saved */
+typedef DWORD_PTR FORCESNLPsolver_affinity;
+
+static int FORCESNLPsolver_pin_thread(solver_int32_default index, FORCESNLPsolver_affinity *saved)
+{
+    DWORD_PTR process, system, cpu;
+    solver_int32_default n = 0;
+
+    if( !GetProcessAffinityMask(GetCurrentProcess(), &process, &system) || process == 0 )
+    {
+        return -1;
+    }
+    for( cpu = 1; cpu != 0; cpu <<= 1 )
+    {
+        n += (process & cpu) != 0;
+    }
+    index %= n;
+    for( cpu = 1; (process & cpu) == 0 || index-- > 0; cpu <<= 1 )
+    {
+    }
+    *saved = SetThreadAffinityMask(GetCurrentThread(), cpu);
+    return *saved != 0 ? 0 : -1;
+}
+
+static void FORCESNLPsolver_unpin_thread(const FORCESNLPsolver_affinity *saved)
+{
+    SetThreadAffinityMask(GetCurrentThread(), *saved);
+}
+
+/* monotonic wall clock in seconds */
+static double FORCESNLPsolver_seconds(void)
+{
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double) t.QuadPart / (double) f.QuadPart;
+}
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+typedef pthread_mutex_t FORCESNLPsolver_mutex;
+typedef pthread_t FORCESNLPsolver_thread;
+#define FORCESNLPsolver_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define FORCESNLPsolver_mutex_init(m)   pthread_mutex_init(m, NULL)
+#define FORCESNLPsolver_mutex_lock(m)   pthread_mutex_lock(m)
+#define FORCESNLPsolver_mutex_unlock(m) pthread_mutex_unlock(m)
+#define FORCESNLPsolver_mutex_free(m)   pthread_mutex_destroy(m)
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define FORCESNLPsolver_THREAD_LOCAL _Thread_local
+#else
+#define FORCESNLPsolver_THREAD_LOCAL __thread
+#endif
+#define FORCESNLPsolver_atomic_add(p, v)   __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+#define FORCESNLPsolver_atomic_load(p)     __atomic_load_n(p, __ATOMIC_RELAXED)
+#define FORCESNLPsolver_atomic_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELAXED)
+typedef pthread_cond_t FORCESNLPsolver_cond;
+#define FORCESNLPsolver_cond_init(c)      pthread_cond_init(c, NULL)
+#define FORCESNLPsolver_cond_wait(c, m)   pthread_cond_wait(c, m)
+#define FORCESNLPsolver_cond_broadcast(c) pthread_cond_broadcast(c)
+#define FORCESNLPsolver_cond_free(c)      pthread_cond_destroy(c)
+#define FORCESNLPsolver_THREAD_FUNC(name) static void *name(void *arg)
+#define FORCESNLPsolver_THREAD_RETURN return NULL
+typedef void *(*FORCESNLPsolver_thread_func)(void *);
+
+static int FORCESNLPsolver_thread_start(FORCESNLPsolver_thread *t, FORCESNLPsolver_thread_func func, void *arg)
+{
+    return pthread_create(t, NULL, func, arg);
+}
+
+static void FORCESNLPsolver_thread_join(FORCESNLPsolver_thread t)
+{
+    pthread_join(t, NULL);
+}
+
+static solver_int32_default FORCESNLPsolver_num_processors(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (solver_int32_default) n : 1;
+}
+
+#if defined(__linux__)
+#include <sched.h>
+
+/* runs the calling thread on the index-th processor the process may use only,
+   its affinity before goes to saved */
+typedef cpu_set_t FORCESNLPsolver_affinity;
+
+static int FORCESNLPsolver_pin_thread(solver_int32_default index, FORCESNLPsolver_affinity *saved)
+{
+    cpu_set_t set;
+    int cpu, n;
+
+    if( sched_getaffinity(0, sizeof(cpu_set_t), saved) != 0 || (n = CPU_COUNT(saved)) == 0 )
+    {
+        return -1;
+    }
+    index %= n;
+    for( cpu = 0; !CPU_ISSET(cpu, saved) || index-- > 0; cpu++ )
+    {
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(cpu_set_t), &set);
+}
+
+static void FORCESNLPsolver_unpin_thread(const FORCESNLPsolver_affinity *saved)
+{
+    sched_setaffinity(0, sizeof(cpu_set_t), saved);
+}
+#else
+/* no thread affinity on this platform */
+typedef int FORCESNLPsolver_affinity;
+
+static int FORCESNLPsolver_pin_thread(solver_int32_default index, FORCESNLPsolver_affinity *saved)
+{
+    (void) index;
+    *saved = 0;
+    return -1;
+}
+
+static void FORCESNLPsolver_unpin_thread(const FORCESNLPsolver_affinity *saved)
+{
+    (void) saved;
+}
+#endif
+
+static double FORCESNLPsolver_seconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1e-9 * (double) t.tv_nsec;
+}
+#endif
+
+
+/* LOCK AROUND SOLVER CORE ----------------------------------------------*/
+/* guards the static storage of the core as well as the runtime settings and,
+ * in an OpenMP build, the evaluation watch below; a core with thread-safe
+ * storage and compiled-in settings needs it for none of its solves, or in an
+ * OpenMP build for those that are watched */
+static FORCESNLPsolver_mutex FORCESNLPsolver_corelock = FORCESNLPsolver_MUTEX_INIT;
+#if defined(_OPENMP)
+#define FORCESNLPsolver_WATCH_NEEDS_LOCK (1)
+#else
+#define FORCESNLPsolver_WATCH_NEEDS_LOCK (0)
+#endif
+#if defined(FORCESNLPsolver_THREADSAFE_STORAGE) && !defined(FORCESNLPsolver_RUNTIME_SETTINGS)
+#define FORCESNLPsolver_CORE_NEEDS_LOCK(watched) ((watched) && FORCESNLPsolver_WATCH_NEEDS_LOCK)
+#else
+#define FORCESNLPsolver_CORE_NEEDS_LOCK(watched) (1)
+#endif
+
+/* settings of the running solve, read by a core built with FORCESNLPsolver_RUNTIME_SETTINGS */
+FORCESNLPsolver_settings FORCESNLPsolver_runtime_settings = {
+    FORCESNLPsolver_DEFAULT_ACC_RDGAP, FORCESNLPsolver_DEFAULT_ACC_RESEQ, FORCESNLPsolver_DEFAULT_ACC_RESINEQ, FORCESNLPsolver_DEFAULT_ACC_KKTCOMPL,
+    FORCESNLPsolver_DEFAULT_FLS_SCALE, FORCESNLPsolver_DEFAULT_MAXIT, FORCESNLPsolver_DEFAULT_MAX_SOC_IT, FORCESNLPsolver_SET_PRINTLEVEL
+};
+
+
+/* LAZY DERIVATIVES -----------------------------------------------------*/
+/* per stage, the last Jacobians and Hessian the model computed and the
+ * variables (and, for the Hessian, the multipliers) they were computed at; the
+ * counters are per stage, so that an OpenMP core evaluating different stages
+ * at once does not share any */
+struct FORCESNLPsolver_lazy
+{
+    FORCESNLPsolver_lazy_options options;
+
+    /* 61 blocks of options.nabla_c_size, nabla_h_size and hess_size floats */
+    FORCESNLPsolver_float *nabla_c;
+    FORCESNLPsolver_float *nabla_h;
+    FORCESNLPsolver_float *hess;
+
+    /* 61 blocks of options.y_size and l_size floats */
+    FORCESNLPsolver_float *yhess;
+    FORCESNLPsolver_float *lhess;
+
+    FORCESNLPsolver_float xjac[61][24];
+    FORCESNLPsolver_float xhess[61][24];
+    int jacvalid[61];
+    int hessvalid[61];
+
+    /* evaluations of the stage in the current solve */
+    solver_int32_default solveevals[61];
+
+    solver_int64_default evals[61];
+    solver_int64_default jacreused[61];
+    solver_int64_default hessreused[61];
+};
+
+FORCESNLPsolver_lazy *FORCESNLPsolver_lazy_create(const FORCESNLPsolver_lazy_options *options)
+{
+    FORCESNLPsolver_lazy *lazy;
+
+    if( options->nabla_c_size < 0 || options->nabla_h_size < 0 || options->hess_size < 0 || options->y_size < 0 || options->l_size < 0 )
+    {
+        return NULL;
+    }
+    lazy = (FORCESNLPsolver_lazy *) calloc(1, sizeof(FORCESNLPsolver_lazy));
+    if( lazy == NULL )
+    {
+        return NULL;
+    }
+    lazy->options = *options;
+    lazy->nabla_c = (FORCESNLPsolver_float *) malloc((61 * (size_t) options->nabla_c_size + 1) * sizeof(FORCESNLPsolver_float));
+    lazy->nabla_h = (FORCESNLPsolver_float *) malloc((61 * (size_t) options->nabla_h_size + 1) * sizeof(FORCESNLPsolver_float));
+    lazy->hess = (FORCESNLPsolver_float *) malloc((61 * (size_t) options->hess_size + 1) * sizeof(FORCESNLPsolver_float));
+    lazy->yhess = (FORCESNLPsolver_float *) malloc((61 * (size_t) options->y_size + 1) * sizeof(FORCESNLPsolver_float));
+    lazy->lhess = (FORCESNLPsolver_float *) malloc((61 * (size_t) options->l_size + 1) * sizeof(FORCESNLPsolver_float));
+    if( lazy->nabla_c == NULL || lazy->nabla_h == NULL || lazy->hess == NULL || lazy->yhess == NULL || lazy->lhess == NULL )
+    {
+        FORCESNLPsolver_lazy_destroy(lazy);
+        return NULL;
+    }
+    return lazy;
+}
+
+void FORCESNLPsolver_lazy_destroy(FORCESNLPsolver_lazy *lazy)
+{
+    if( lazy != NULL )
+    {
+        free(lazy->nabla_c);
+        free(lazy->nabla_h);
+        free(lazy->hess);
+        free(lazy->yhess);
+        free(lazy->lhess);
+        free(lazy);
+    }
+}
+
+void FORCESNLPsolver_lazy_get_stats(const FORCESNLPsolver_lazy *lazy, FORCESNLPsolver_lazy_stats *stats)
+{
+    solver_int32_default i;
+
+    memset(stats, 0, sizeof(FORCESNLPsolver_lazy_stats));
+    for( i = 0; i < 61; i++ )
+    {
+        stats->evals += lazy->evals[i];
+        stats->jacobians_reused += lazy->jacreused[i];
+        stats->hessians_reused += lazy->hessreused[i];
+    }
+}
+
+void FORCESNLPsolver_set_lazy(FORCESNLPsolver_context *ctx, FORCESNLPsolver_lazy *lazy)
+{
+    ctx->lazy = lazy;
+}
+
+/* derivatives of an earlier solve are not reused */
+static void FORCESNLPsolver_lazy_start(FORCESNLPsolver_lazy *lazy)
+{
+    memset(lazy->jacvalid, 0, sizeof(lazy->jacvalid));
+    memset(lazy->hessvalid, 0, sizeof(lazy->hessvalid));
+    memset(lazy->solveevals, 0, sizeof(lazy->solveevals));
+}
+
+/* 1 if none of the n values of x is farther than tol from ref */
+static int FORCESNLPsolver_lazy_near(const FORCESNLPsolver_float *ref, const FORCESNLPsolver_float *x, solver_int32_default n, FORCESNLPsolver_float tol)
+{
+    solver_int32_default i;
+
+    for( i = 0; i < n; i++ )
+    {
+        if( !(fabs((double) (x[i] - ref[i])) <= (double) tol) )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* one evaluation of stage with the reusable derivatives taken from lazy; an
+   output counts as needed if the core passes a buffer for it */
+static void FORCESNLPsolver_lazy_eval(FORCESNLPsolver_lazy *lazy, FORCESNLPsolver_extfunc extfunc, FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage)
+{
+    const FORCESNLPsolver_lazy_options *o = &lazy->options;
+    FORCESNLPsolver_float *storec, *storeh, *storehess, *storey, *storel;
+    solver_int32_unsigned needed = 0;
+    int jacobians = nabla_c != NULL || nabla_h != NULL;
+    int reusejac = 0, reusehess = 0;
+
+    if( stage < 0 || stage >= 61 )
+    {
+        extfunc(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage);
+        return;
+    }
+    storec = lazy->nabla_c + stage * o->nabla_c_size;
+    storeh = lazy->nabla_h + stage * o->nabla_h_size;
+    storehess = lazy->hess + stage * o->hess_size;
+    storey = lazy->yhess + stage * o->y_size;
+    storel = lazy->lhess + stage * o->l_size;
+    lazy->evals[stage]++;
+    lazy->solveevals[stage]++;
+
+    /* Jacobians only as a pair, so that both were taken at the same point */
+    if( jacobians && lazy->jacvalid[stage] && o->jacobian_tol > 0 && (nabla_c == NULL || o->nabla_c_size > 0) && (nabla_h == NULL || o->nabla_h_size > 0) )
+    {
+        reusejac = FORCESNLPsolver_lazy_near(lazy->xjac[stage], x, 24, o->jacobian_tol);
+    }
+    if( hess != NULL && lazy->hessvalid[stage] && o->hess_size > 0 )
+    {
+        reusehess = (o->freeze_after > 0 && lazy->solveevals[stage] > o->freeze_after) ||
+                    (o->hessian_tol > 0 && FORCESNLPsolver_lazy_near(lazy->xhess[stage], x, 24, o->hessian_tol) &&
+                     (o->y_size == 0 || (y != NULL && FORCESNLPsolver_lazy_near(storey, y, o->y_size, o->hessian_tol))) &&
+                     (o->l_size == 0 || (l != NULL && FORCESNLPsolver_lazy_near(storel, l, o->l_size, o->hessian_tol))));
+    }
+
+    needed |= f != NULL ? FORCESNLPsolver_NEED_F : 0;
+    needed |= nabla_f != NULL ? FORCESNLPsolver_NEED_NABLA_F : 0;
+    needed |= c != NULL ? FORCESNLPsolver_NEED_C : 0;
+    needed |= h != NULL ? FORCESNLPsolver_NEED_H : 0;
+    needed |= nabla_c != NULL && !reusejac ? FORCESNLPsolver_NEED_NABLA_C : 0;
+    needed |= nabla_h != NULL && !reusejac ? FORCESNLPsolver_NEED_NABLA_H : 0;
+    needed |= hess != NULL && !reusehess ? FORCESNLPsolver_NEED_HESS : 0;
+    if( o->func != NULL )
+    {
+        o->func(x, y, l, p, f, nabla_f, c, reusejac ? NULL : nabla_c, h, reusejac ? NULL : nabla_h, reusehess ? NULL : hess, stage, needed);
+    }
+    else
+    {
+        extfunc(x, y, l, p, f, nabla_f, c, reusejac ? NULL : nabla_c, h, reusejac ? NULL : nabla_h, reusehess ? NULL : hess, stage);
+    }
+
+    if( reusejac )
+    {
+        if( nabla_c != NULL )
+        {
+            memcpy(nabla_c, storec, o->nabla_c_size * sizeof(FORCESNLPsolver_float));
+        }
+        if( nabla_h != NULL )
+        {
+            memcpy(nabla_h, storeh, o->nabla_h_size * sizeof(FORCESNLPsolver_float));
+        }
+        lazy->jacreused[stage]++;
+    }
+    else if( jacobians )
+    {
+        /* only a pair evaluated together can be reused */
+        lazy->jacvalid[stage] = (nabla_c != NULL || o->nabla_c_size == 0) && (nabla_h != NULL || o->nabla_h_size == 0);
+        if( nabla_c != NULL )
+        {
+            memcpy(storec, nabla_c, o->nabla_c_size * sizeof(FORCESNLPsolver_float));
+        }
+        if( nabla_h != NULL )
+        {
+            memcpy(storeh, nabla_h, o->nabla_h_size * sizeof(FORCESNLPsolver_float));
+        }
+        memcpy(lazy->xjac[stage], x, sizeof(lazy->xjac[stage]));
+    }
+
+    if( reusehess )
+    {
+        memcpy(hess, storehess, o->hess_size * sizeof(FORCESNLPsolver_float));
+        lazy->hessreused[stage]++;
+    }
+    else if( hess != NULL && o->hess_size > 0 )
+    {
+        memcpy(storehess, hess, o->hess_size * sizeof(FORCESNLPsolver_float));
+        memcpy(lazy->xhess[stage], x, sizeof(lazy->xhess[stage]));
+        if( y != NULL )
+        {
+            memcpy(storey, y, o->y_size * sizeof(FORCESNLPsolver_float));
+        }
+        if( l != NULL )
+        {
+            memcpy(storel, l, o->l_size * sizeof(FORCESNLPsolver_float));
+        }
+        lazy->hessvalid[stage] = 1;
+    }
+}
+
+
+/* EVALUATION WATCH -----------------------------------------------------*/
+/* The core has no notion of wall clock time. Solves with a time limit, a
+ * profile or a trace get their external functions through
+ * FORCESNLPsolver_watch_extfunc, which times each evaluation, sums up the stage
+ * costs of each sweep over the stages and returns a NaN objective once the
+ * time is up so that the core stops with FORCESNLPsolver_BADFUNCEVAL at its
+ * next evaluation; with a derivative store the evaluations go through it.
+ * The state of the watch lives on the stack of the core call. The external
+ * function has no user data, so the watch finds it through a pointer of the
+ * calling thread, on which the core evaluates; an OpenMP core evaluates on
+ * the threads of its team instead, which only see a pointer of the process,
+ * so watched solves take the core lock there. It may still call the watch
+ * from several threads at once, for different stages. */
+typedef struct FORCESNLPsolver_watch
+{
+    FORCESNLPsolver_extfunc func;
+    FORCESNLPsolver_lazy *lazy;
+    FORCESNLPsolver_profile *profile;
+    FORCESNLPsolver_trace *trace;
+    int limited;
+    double start;
+    double end;
+    volatile int expired;
+
+    /* cost evaluations of each stage so far; the n-th one of stage k, which
+       belongs to sweep n, leaves its cost and time in cost and done [n & 1][k],
+       so that the stages of the next sweep do not overwrite those of a sweep
+       that is still being recorded */
+    solver_int64_default fevals[61];
+    double cost[2][61];
+    double done[2][61];
+
+} FORCESNLPsolver_watch;
+
+#if defined(_OPENMP)
+static FORCESNLPsolver_watch *FORCESNLPsolver_watch_current = NULL;
+#else
+static FORCESNLPsolver_THREAD_LOCAL FORCESNLPsolver_watch *FORCESNLPsolver_watch_current = NULL;
+#endif
+
+/* puts sweep n into the trace ring if every stage has evaluated its cost for
+   it, with the objective summed over the stages and the time of the last one */
+static void FORCESNLPsolver_trace_record(FORCESNLPsolver_watch *watch, solver_int64_default n)
+{
+    FORCESNLPsolver_trace *trace = watch->trace;
+    FORCESNLPsolver_trace_entry *entry;
+    double pobj = 0.0, time = watch->start;
+    int k, b = (int) (n & 1);
+
+    for( k = 0; k < 61; k++ )
+    {
+        if( FORCESNLPsolver_atomic_load(&watch->fevals[k]) <= n )
+        {
+            return;
+        }
+    }
+    for( k = 0; k < 61; k++ )
+    {
+        pobj += watch->cost[b][k];
+        time = watch->done[b][k] > time ? watch->done[b][k] : time;
+    }
+    entry = &trace->entries[trace->count % FORCESNLPsolver_TRACE_SIZE];
+    entry->sweep = (solver_int32_default) n;
+    entry->pobj = (FORCESNLPsolver_float) pobj;
+    entry->time = time - watch->start;
+    trace->count++;
+}
+
+/* notes the cost of one stage evaluation; the cost evaluation of stage 0
+   that starts a sweep completes the one before, which the core has fully
+   evaluated by then (an OpenMP core joins its team between sweeps).
+   Evaluations of derivatives only and of unknown stages are not sweeps. */
+static void FORCESNLPsolver_trace_sweep(FORCESNLPsolver_watch *watch, solver_int32_default stage, const FORCESNLPsolver_float *f, double now)
+{
+    solver_int64_default n;
+
+    if( f == NULL || stage < 0 || stage >= 61 )
+    {
+        return;
+    }
+    n = FORCESNLPsolver_atomic_load(&watch->fevals[stage]);
+    watch->cost[n & 1][stage] = (double) *f;
+    watch->done[n & 1][stage] = now;
+    FORCESNLPsolver_atomic_add(&watch->fevals[stage], 1);
+    if( stage == 0 && n > 0 )
+    {
+        FORCESNLPsolver_trace_record(watch, n - 1);
+    }
+}
+
+static void FORCESNLPsolver_watch_extfunc(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage)
+{
+    FORCESNLPsolver_watch *watch = FORCESNLPsolver_watch_current;
+    double start = FORCESNLPsolver_seconds(), end;
+
+    if( watch->lazy != NULL )
+    {
+        FORCESNLPsolver_lazy_eval(watch->lazy, watch->func, x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage);
+    }
+    else
+    {
+        watch->func(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage);
+    }
+    end = FORCESNLPsolver_seconds();
+    if( watch->profile != NULL && stage >= 0 && stage < 61 )
+    {
+        watch->profile->evals[stage]++;
+        watch->profile->evaltime[stage] += end - start;
+    }
+    if( watch->trace != NULL )
+    {
+        FORCESNLPsolver_trace_sweep(watch, stage, f, end);
+    }
+    if( watch->limited && (watch->expired || end > watch->end) )
+    {
+        watch->expired = 1;
+        if( f != NULL )
+        {
+            *f = (FORCESNLPsolver_float) NAN;
+        }
+    }
+}
+
+
+/* METRICS --------------------------------------------------------------*/
+/* all int64, so that they can be copied and cleared as an array; times in
+ * nanoseconds */
+typedef struct FORCESNLPsolver_counters
+{
+    solver_int64_default solves[FORCESNLPsolver_METRICS_NEXITFLAGS];
+    solver_int64_default iterations[FORCESNLPsolver_METRICS_NITERATIONS + 1];
+    solver_int64_default solvetime[FORCESNLPsolver_METRICS_NSECONDS + 1];
+    solver_int64_default fevalstime[FORCESNLPsolver_METRICS_NSECONDS + 1];
+    solver_int64_default iterations_sum;
+    solver_int64_default solvetime_ns;
+    solver_int64_default fevalstime_ns;
+    solver_int64_default warmstarts;
+    solver_int64_default cache_hits;
+    solver_int64_default cache_misses;
+
+} FORCESNLPsolver_counters;
+
+static FORCESNLPsolver_counters FORCESNLPsolver_metrics_counters;
+
+static const double FORCESNLPsolver_metrics_iterations[FORCESNLPsolver_METRICS_NITERATIONS] = FORCESNLPsolver_METRICS_ITERATIONS;
+static const double FORCESNLPsolver_metrics_seconds[FORCESNLPsolver_METRICS_NSECONDS] = FORCESNLPsolver_METRICS_SECONDS;
+static const char *const FORCESNLPsolver_metrics_exitflags[FORCESNLPsolver_METRICS_NEXITFLAGS] =
+    {"OPTIMAL", "MAXITREACHED", "FACTORIZATION_ERROR", "BADFUNCEVAL", "NOPROGRESS", "TIMELIMIT_REACHED", "OTHER"};
+
+#define FORCESNLPsolver_metrics_count(counter) FORCESNLPsolver_atomic_add(&FORCESNLPsolver_metrics_counters.counter, 1)
+
+/* bucket of value, NaN in the last */
+static int FORCESNLPsolver_metrics_bucket(const double *bounds, int n, double value)
+{
+    int k = 0;
+
+    while( k < n && !(value <= bounds[k]) )
+    {
+        k++;
+    }
+    return k;
+}
+
+static solver_int64_default FORCESNLPsolver_metrics_ns(double seconds)
+{
+    return seconds > 0 ? (solver_int64_default) (seconds * 1e9) : 0;
+}
+
+/* count one solve of the core */
+static void FORCESNLPsolver_metrics_solve(solver_int32_default exitflag, const FORCESNLPsolver_info *info)
+{
+    FORCESNLPsolver_counters *c = &FORCESNLPsolver_metrics_counters;
+    double solvetime = (double) info->solvetime, fevalstime = (double) info->fevalstime;
+    int k;
+
+    switch( exitflag )
+    {
+        case FORCESNLPsolver_OPTIMAL:             k = FORCESNLPsolver_METRICS_OPTIMAL; break;
+        case FORCESNLPsolver_MAXITREACHED:        k = FORCESNLPsolver_METRICS_MAXITREACHED; break;
+        case FORCESNLPsolver_FACTORIZATION_ERROR: k = FORCESNLPsolver_METRICS_FACTORIZATION_ERROR; break;
+        case FORCESNLPsolver_BADFUNCEVAL:         k = FORCESNLPsolver_METRICS_BADFUNCEVAL; break;
+        case FORCESNLPsolver_NOPROGRESS:          k = FORCESNLPsolver_METRICS_NOPROGRESS; break;
+        case FORCESNLPsolver_TIMELIMIT_REACHED:   k = FORCESNLPsolver_METRICS_TIMELIMIT_REACHED; break;
+        default:                                  k = FORCESNLPsolver_METRICS_OTHER; break;
+    }
+    FORCESNLPsolver_atomic_add(&c->solves[k], 1);
+    FORCESNLPsolver_atomic_add(&c->iterations[FORCESNLPsolver_metrics_bucket(FORCESNLPsolver_metrics_iterations, FORCESNLPsolver_METRICS_NITERATIONS, (double) info->it)], 1);
+    FORCESNLPsolver_atomic_add(&c->iterations_sum, (solver_int64_default) info->it);
+    FORCESNLPsolver_atomic_add(&c->solvetime[FORCESNLPsolver_metrics_bucket(FORCESNLPsolver_metrics_seconds, FORCESNLPsolver_METRICS_NSECONDS, solvetime)], 1);
+    FORCESNLPsolver_atomic_add(&c->solvetime_ns, FORCESNLPsolver_metrics_ns(solvetime));
+    FORCESNLPsolver_atomic_add(&c->fevalstime[FORCESNLPsolver_metrics_bucket(FORCESNLPsolver_metrics_seconds, FORCESNLPsolver_METRICS_NSECONDS, fevalstime)], 1);
+    FORCESNLPsolver_atomic_add(&c->fevalstime_ns, FORCESNLPsolver_metrics_ns(fevalstime));
+}
+
+void FORCESNLPsolver_get_metrics(FORCESNLPsolver_metrics *metrics)
+{
+    FORCESNLPsolver_counters c;
+    solver_int64_default *src = (solver_int64_default *) &FORCESNLPsolver_metrics_counters, *dst = (solver_int64_default *) &c;
+    size_t i;
+
+    for( i = 0; i < sizeof(c) / sizeof(solver_int64_default); i++ )
+    {
+        dst[i] = FORCESNLPsolver_atomic_load(&src[i]);
+    }
+    memcpy(metrics->solves, c.solves, sizeof(c.solves));
+    memcpy(metrics->iterations, c.iterations, sizeof(c.iterations));
+    memcpy(metrics->solvetime, c.solvetime, sizeof(c.solvetime));
+    memcpy(metrics->fevalstime, c.fevalstime, sizeof(c.fevalstime));
+    metrics->iterations_sum = c.iterations_sum;
+    metrics->solvetime_sum = (double) c.solvetime_ns * 1e-9;
+    metrics->fevalstime_sum = (double) c.fevalstime_ns * 1e-9;
+    metrics->warmstarts = c.warmstarts;
+    metrics->cache_hits = c.cache_hits;
+    metrics->cache_misses = c.cache_misses;
+}
+
+void FORCESNLPsolver_reset_metrics(void)
+{
+    solver_int64_default *p = (solver_int64_default *) &FORCESNLPsolver_metrics_counters;
+    size_t i;
+
+    for( i = 0; i < sizeof(FORCESNLPsolver_counters) / sizeof(solver_int64_default); i++ )
+    {
+        FORCESNLPsolver_atomic_store(&p[i], 0);
+    }
+}
+
+/* format appended at len of buf like snprintf, returns the new length */
+static size_t FORCESNLPsolver_metrics_printf(char *buf, size_t size, size_t len, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(len < size ? buf + len : NULL, len < size ? size - len : 0, format, args);
+    va_end(args);
+    return n > 0 ? len + (size_t) n : len;
+}
+
+static size_t FORCESNLPsolver_metrics_histogram(char *buf, size_t size, size_t len, const char *name, const char *help,
+                                                const double *bounds, int n, const solver_int64_default *counts, double sum)
+{
+    solver_int64_default total = 0;
+    int k;
+
+    len = FORCESNLPsolver_metrics_printf(buf, size, len, "# HELP forcesnlpsolver_%s %s\n# TYPE forcesnlpsolver_%s histogram\n", name, help, name);
+    for( k = 0; k < n; k++ )
+    {
+        total += counts[k];
+        len = FORCESNLPsolver_metrics_printf(buf, size, len, "forcesnlpsolver_%s_bucket{le=\"%g\"} %lld\n", name, bounds[k], total);
+    }
+    total += counts[n];
+    len = FORCESNLPsolver_metrics_printf(buf, size, len, "forcesnlpsolver_%s_bucket{le=\"+Inf\"} %lld\n", name, total);
+    len = FORCESNLPsolver_metrics_printf(buf, size, len, "forcesnlpsolver_%s_sum %.9g\n", name, sum);
+    return FORCESNLPsolver_metrics_printf(buf, size, len, "forcesnlpsolver_%s_count %lld\n", name, total);
+}
+
+static size_t FORCESNLPsolver_metrics_counter(char *buf, size_t size, size_t len, const char *name, const char *help, solver_int64_default value)
+{
+    return FORCESNLPsolver_metrics_printf(buf, size, len, "# HELP forcesnlpsolver_%s %s\n# TYPE forcesnlpsolver_%s counter\nforcesnlpsolver_%s %lld\n", name, help, name, name, value);
+}
+
+size_t FORCESNLPsolver_metrics_export(char *buf, size_t size)
+{
+    FORCESNLPsolver_metrics m;
+    size_t len = 0;
+    int k;
+
+    FORCESNLPsolver_get_metrics(&m);
+    if( size > 0 )
+    {
+        buf[0] = '\0';
+    }
+    len = FORCESNLPsolver_metrics_printf(buf, size, len, "# HELP forcesnlpsolver_solves_total Solves of the solver core by exitflag.\n# TYPE forcesnlpsolver_solves_total counter\n");
+    for( k = 0; k < FORCESNLPsolver_METRICS_NEXITFLAGS; k++ )
+    {
+        len = FORCESNLPsolver_metrics_printf(buf, size, len, "forcesnlpsolver_solves_total{exitflag=\"%s\"} %lld\n", FORCESNLPsolver_metrics_exitflags[k], m.solves[k]);
+    }
+    len = FORCESNLPsolver_metrics_histogram(buf, size, len, "iterations", "Iterations per solve.",
+                                            FORCESNLPsolver_metrics_iterations, FORCESNLPsolver_METRICS_NITERATIONS, m.iterations, (double) m.iterations_sum);
+    len = FORCESNLPsolver_metrics_histogram(buf, size, len, "solve_seconds", "Solve time (info.solvetime).",
+                                            FORCESNLPsolver_metrics_seconds, FORCESNLPsolver_METRICS_NSECONDS, m.solvetime, m.solvetime_sum);
+    len = FORCESNLPsolver_metrics_histogram(buf, size, len, "fevals_seconds", "Time in function evaluations per solve (info.fevalstime).",
+                                            FORCESNLPsolver_metrics_seconds, FORCESNLPsolver_METRICS_NSECONDS, m.fevalstime, m.fevalstime_sum);
+    len = FORCESNLPsolver_metrics_counter(buf, size, len, "warmstarts_total", "Solves started from a stored or cached solution.", m.warmstarts);
+    len = FORCESNLPsolver_metrics_counter(buf, size, len, "cache_hits_total", "Solves answered from a solve cache.", m.cache_hits);
+    len = FORCESNLPsolver_metrics_counter(buf, size, len, "cache_misses_total", "Solve cache lookups without a matching entry.", m.cache_misses);
+    return len;
+}
+
+
+/* CORE CALL ------------------------------------------------------------*/
+/* one call of the core with the settings, time limit, OpenMP thread count,
+ * profile, trace and derivative store of options, or with the defaults if
+ * options is NULL */
+static solver_int32_default FORCESNLPsolver_core_solve(FORCESNLPsolver_params *params, FORCESNLPsolver_output *output, FORCESNLPsolver_info *info, FILE *fs, FORCESNLPsolver_extfunc extfunc,
+                                                       const FORCESNLPsolver_context *options)
+{
+    solver_int32_default exitflag, i;
+    int limited = options != NULL && options->timelimit > 0;
+    FORCESNLPsolver_profile *profile = options != NULL ? options->profile : NULL;
+    FORCESNLPsolver_trace *trace = options != NULL ? options->trace : NULL;
+    FORCESNLPsolver_lazy *lazy = options != NULL ? options->lazy : NULL;
+    int watched = limited || profile != NULL || trace != NULL || lazy != NULL;
+    int locked = FORCESNLPsolver_CORE_NEEDS_LOCK(watched);
+    FORCESNLPsolver_watch watch, *outer = NULL;
+    double start = 0.0;
+#if defined(_OPENMP)
+    int ompthreads;
+#endif
+
+    if( locked )
+    {
+        FORCESNLPsolver_mutex_lock(&FORCESNLPsolver_corelock);
+    }
+#ifdef FORCESNLPsolver_RUNTIME_SETTINGS
+    /* only read by such a core, which always runs under the lock */
+    if( options != NULL )
+    {
+        FORCESNLPsolver_runtime_settings = options->settings;
+    }
+    else
+    {
+        FORCESNLPsolver_default_settings(&FORCESNLPsolver_runtime_settings);
+    }
+#endif
+    if( options != NULL && options->settings.printlevel <= 0 )
+    {
+        fs = NULL;
+    }
+    if( watched )
+    {
+        memset(&watch, 0, sizeof(watch));
+        watch.func = extfunc;
+        watch.profile = profile;
+        watch.trace = trace;
+        watch.lazy = lazy;
+        watch.limited = limited;
+        start = FORCESNLPsolver_seconds();
+        watch.start = start;
+        watch.end = limited ? start + (double) options->timelimit : 0.0;
+        extfunc = FORCESNLPsolver_watch_extfunc;
+
+        /* a solve from inside an external function gets back its caller's watch */
+        outer = FORCESNLPsolver_watch_current;
+        FORCESNLPsolver_watch_current = &watch;
+        if( trace != NULL )
+        {
+            trace->count = 0;
+        }
+        if( lazy != NULL )
+        {
+            FORCESNLPsolver_lazy_start(lazy);
+        }
+    }
+#if defined(_OPENMP)
+    /* thread count of the parallel regions started by this thread, restored afterwards */
+    ompthreads = omp_get_max_threads();
+    if( options != NULL && options->nthreads > 0 )
+    {
+        omp_set_num_threads(options->nthreads);
+    }
+#endif
+    exitflag = FORCESNLPsolver_solve(params, output, info, fs, extfunc);
+#if defined(_OPENMP)
+    omp_set_num_threads(ompthreads);
+#endif
+    if( watched )
+    {
+        FORCESNLPsolver_watch_current = outer;
+    }
+    if( trace != NULL && watch.fevals[0] > 0 )
+    {
+        /* the last sweep has no next one to complete it */
+        FORCESNLPsolver_trace_record(&watch, watch.fevals[0] - 1);
+    }
+    if( limited && watch.expired && exitflag != FORCESNLPsolver_OPTIMAL )
+    {
+        exitflag = FORCESNLPsolver_TIMELIMIT_REACHED;
+    }
+    if( profile != NULL )
+    {
+        profile->nsolves++;
+        profile->iterations += info->it;
+        profile->solvetime += FORCESNLPsolver_seconds() - start;
+        profile->fevalstime = 0.0;
+        for( i = 0; i < 61; i++ )
+        {
+            profile->fevalstime += profile->evaltime[i];
+        }
+        profile->coretime = profile->solvetime - profile->fevalstime;
+    }
+    if( locked )
+    {
+        FORCESNLPsolver_mutex_unlock(&FORCESNLPsolver_corelock);
+    }
+    FORCESNLPsolver_metrics_solve(exitflag, info);
+    return exitflag;
+}
+
+
+/* CONTEXT LIFETIME -----------------------------------------------------*/
+solver_int32_default FORCESNLPsolver_float_size(void)
+{
+    return (solver_int32_default) sizeof(FORCESNLPsolver_float);
+}
+
+void FORCESNLPsolver_init(FORCESNLPsolver_context *ctx, FORCESNLPsolver_extfunc extfunc)
+{
+    memset(ctx, 0, sizeof(FORCESNLPsolver_context));
+    ctx->extfunc = extfunc;
+    ctx->fs = NULL;
+    FORCESNLPsolver_default_settings(&ctx->settings);
+}
+
+size_t FORCESNLPsolver_workspace_size(void)
+{
+    return (sizeof(FORCESNLPsolver_context) + FORCESNLPsolver_ALIGNMENT - 1) / FORCESNLPsolver_ALIGNMENT * FORCESNLPsolver_ALIGNMENT;
+}
+
+FORCESNLPsolver_context *FORCESNLPsolver_create_in(void *arena, size_t size, FORCESNLPsolver_extfunc extfunc)
+{
+    if( arena == NULL || (uintptr_t) arena % FORCESNLPsolver_ALIGNMENT != 0 || size < FORCESNLPsolver_workspace_size() )
+    {
+        return NULL;
+    }
+    FORCESNLPsolver_init((FORCESNLPsolver_context *) arena, extfunc);
+    return (FORCESNLPsolver_context *) arena;
+}
+
+FORCESNLPsolver_context *FORCESNLPsolver_create(FORCESNLPsolver_extfunc extfunc)
+{
+    void *mem;
+
+    /* aligned, so that contexts of different threads do not share cache lines */
+#if defined(_WIN32)
+    mem = _aligned_malloc(FORCESNLPsolver_workspace_size(), FORCESNLPsolver_ALIGNMENT);
+#else
+    if( posix_memalign(&mem, FORCESNLPsolver_ALIGNMENT, FORCESNLPsolver_workspace_size()) != 0 )
+    {
+        mem = NULL;
+    }
+#endif
+    return FORCESNLPsolver_create_in(mem, FORCESNLPsolver_workspace_size(), extfunc);
+}
+
+void FORCESNLPsolver_destroy(FORCESNLPsolver_context *ctx)
+{
+#if defined(_WIN32)
+    _aligned_free(ctx);
+#else
+    free(ctx);
+#endif
+}
+
+void FORCESNLPsolver_set_log(FORCESNLPsolver_context *ctx, FORCESNLPsolver_logfunc func, void *userdata)
+{
+    ctx->logfunc = func;
+    ctx->loguser = userdata;
+}
+
+void FORCESNLPsolver_set_num_threads(FORCESNLPsolver_context *ctx, solver_int32_default n)
+{
+    ctx->nthreads = n > 0 ? n : 0;
+}
+
+void FORCESNLPsolver_default_settings(FORCESNLPsolver_settings *settings)
+{
+    settings->acc_rdgap = FORCESNLPsolver_DEFAULT_ACC_RDGAP;
+    settings->acc_reseq = FORCESNLPsolver_DEFAULT_ACC_RESEQ;
+    settings->acc_resineq = FORCESNLPsolver_DEFAULT_ACC_RESINEQ;
+    settings->acc_kktcompl = FORCESNLPsolver_DEFAULT_ACC_KKTCOMPL;
+    settings->fls_scale = FORCESNLPsolver_DEFAULT_FLS_SCALE;
+    settings->maxit = FORCESNLPsolver_DEFAULT_MAXIT;
+    settings->max_soc_it = FORCESNLPsolver_DEFAULT_MAX_SOC_IT;
+    settings->printlevel = FORCESNLPsolver_SET_PRINTLEVEL;
+}
+
+void FORCESNLPsolver_set_settings(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_settings *settings)
+{
+    if( settings != NULL )
+    {
+        ctx->settings = *settings;
+    }
+    else
+    {
+        FORCESNLPsolver_default_settings(&ctx->settings);
+    }
+}
+
+void FORCESNLPsolver_set_time_limit(FORCESNLPsolver_context *ctx, FORCESNLPsolver_float seconds)
+{
+    ctx->timelimit = seconds > 0 ? seconds : 0;
+}
+
+void FORCESNLPsolver_set_profile(FORCESNLPsolver_context *ctx, FORCESNLPsolver_profile *profile)
+{
+    ctx->profile = profile;
+}
+
+void FORCESNLPsolver_reset_profile(FORCESNLPsolver_profile *profile)
+{
+    memset(profile, 0, sizeof(FORCESNLPsolver_profile));
+}
+
+void FORCESNLPsolver_set_trace(FORCESNLPsolver_context *ctx, FORCESNLPsolver_trace *trace)
+{
+    if( trace != NULL )
+    {
+        trace->count = 0;
+    }
+    ctx->trace = trace;
+}
+
+void FORCESNLPsolver_reset_warmstart(FORCESNLPsolver_context *ctx)
+{
+    ctx->warm_valid = 0;
+}
+
+
+/* DIMENSIONS -----------------------------------------------------------*/
+void FORCESNLPsolver_get_dims(FORCESNLPsolver_dims *dims)
+{
+    dims->nstages = 61;
+    dims->nvar = 24;
+    dims->npar = 41;
+    dims->nxinit = 16;
+    dims->nxfinal = 11;
+}
+
+solver_int32_default FORCESNLPsolver_resample_stages(const FORCESNLPsolver_float *src, solver_int32_default nsrc, FORCESNLPsolver_float *dst, solver_int32_default ndst, solver_int32_default width)
+{
+    solver_int32_default j, i, lo;
+    double pos, w;
+    const FORCESNLPsolver_float *a, *b;
+
+    if( nsrc < 1 || ndst < 1 || width < 1 )
+    {
+        return -1;
+    }
+    for( j = 0; j < ndst; j++ )
+    {
+        /* position of stage j in src, and the stage pair around it */
+        pos = ndst > 1 ? (double) j * (nsrc - 1) / (ndst - 1) : 0.0;
+        lo = (solver_int32_default) pos;
+        if( lo >= nsrc - 1 )
+        {
+            lo = nsrc - 1;
+        }
+        w = pos - lo;
+        a = src + (size_t) lo * width;
+        b = lo + 1 < nsrc ? a + width : a;
+        for( i = 0; i < width; i++ )
+        {
+            dst[(size_t) j * width + i] = (FORCESNLPsolver_float) ((1.0 - w) * a[i] + w * b[i]);
+        }
+    }
+    return 0;
+}
+
+
+/* PARAMETER UPDATES ----------------------------------------------------*/
+/* nonzero if n non-overlapping blocks of len values at first + j*stride fit into all_parameters */
+static int FORCESNLPsolver_slice_fits(solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default n)
+{
+    if( len < 0 )
+    {
+        return 0;
+    }
+    if( n <= 0 || len == 0 )
+    {
+        return 1;
+    }
+    return first >= 0 && (n == 1 || stride >= len) && (long) first + (long) (n - 1) * stride + len <= 2501;
+}
+
+solver_int32_default FORCESNLPsolver_set_stage_params(FORCESNLPsolver_context *ctx, solver_int32_default stage, const FORCESNLPsolver_float *values)
+{
+    if( stage < 0 || stage >= 61 )
+    {
+        return -1;
+    }
+    return FORCESNLPsolver_set_param_slice(ctx, 41 * stage, 41, 41, 1, values);
+}
+
+solver_int32_default FORCESNLPsolver_set_param_slice(FORCESNLPsolver_context *ctx, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default n, const FORCESNLPsolver_float *values)
+{
+    solver_int32_default j;
+
+    if( !FORCESNLPsolver_slice_fits(first, len, stride, n) )
+    {
+        return -1;
+    }
+    for( j = 0; j < n; j++ )
+    {
+        memcpy(ctx->params.all_parameters + first + j * stride, values + j * len, len * sizeof(FORCESNLPsolver_float));
+    }
+    return 0;
+}
+
+
+/* WARM START -----------------------------------------------------------*/
+/* nonzero if params.x0 was overwritten */
+static int FORCESNLPsolver_apply_warmstart(FORCESNLPsolver_context *ctx)
+{
+    if( !ctx->warm_valid || ctx->warmstart == FORCESNLPsolver_WARMSTART_OFF )
+    {
+        return 0;
+    }
+    if( ctx->warmstart == FORCESNLPsolver_WARMSTART_SHIFT )
+    {
+        memcpy(ctx->params.x0, ctx->warm_x + 24, (1464 - 24) * sizeof(FORCESNLPsolver_float));
+        memcpy(ctx->params.x0 + 1464 - 24, ctx->warm_x + 1464 - 24, 24 * sizeof(FORCESNLPsolver_float));
+    }
+    else
+    {
+        memcpy(ctx->params.x0, ctx->warm_x, 1464 * sizeof(FORCESNLPsolver_float));
+    }
+    return 1;
+}
+
+static void FORCESNLPsolver_store_warmstart(FORCESNLPsolver_context *ctx)
+{
+    if( ctx->exitflag == FORCESNLPsolver_OPTIMAL )
+    {
+        /* the 61 stage vectors of FORCESNLPsolver_output are contiguous, like x0 */
+        memcpy(ctx->warm_x, &ctx->output, 1464 * sizeof(FORCESNLPsolver_float));
+        ctx->warm_valid = 1;
+    }
+}
+
+
+/* SOLVE CACHE ----------------------------------------------------------*/
+/* key of a problem: xinit, xfinal and all_parameters, which follow x0 in
+ * FORCESNLPsolver_params, and the settings */
+#define FORCESNLPsolver_CACHE_KEY_FIRST (1464)
+#define FORCESNLPsolver_CACHE_KEY_SIZE  (16 + 11 + 2501)
+#define FORCESNLPsolver_CACHE_NONE      (-1)
+
+typedef struct FORCESNLPsolver_cache_entry
+{
+    FORCESNLPsolver_float key[FORCESNLPsolver_CACHE_KEY_SIZE];
+    FORCESNLPsolver_settings settings;
+    solver_int64_unsigned hash;
+
+    FORCESNLPsolver_output output;
+    FORCESNLPsolver_info info;
+    solver_int32_default exitflag;
+
+    /* next entry of the same bucket, and neighbours in the recency list */
+    solver_int32_default next;
+    solver_int32_default newer;
+    solver_int32_default older;
+
+} FORCESNLPsolver_cache_entry;
+
+struct FORCESNLPsolver_cache
+{
+    FORCESNLPsolver_mutex lock;
+    FORCESNLPsolver_cache_entry *entries;
+
+    /* chains of entries by hash, nbuckets is a power of two */
+    solver_int32_default *buckets;
+    solver_int32_default nbuckets;
+
+    /* most and least recently used entry */
+    solver_int32_default newest;
+    solver_int32_default oldest;
+
+    FORCESNLPsolver_cache_stats stats;
+};
+
+/* FNV-1a step over size bytes */
+static solver_int64_unsigned FORCESNLPsolver_fnv1a(solver_int64_unsigned hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    size_t i;
+
+    for( i = 0; i < size; i++ )
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* FNV-1a over the bytes of the key and of each settings member that changes
+   the result; printlevel only changes the printout */
+static solver_int64_unsigned FORCESNLPsolver_cache_hash(const FORCESNLPsolver_float *key, const FORCESNLPsolver_settings *settings)
+{
+    solver_int64_unsigned hash = 14695981039346656037ULL;
+
+    hash = FORCESNLPsolver_fnv1a(hash, key, FORCESNLPsolver_CACHE_KEY_SIZE * sizeof(FORCESNLPsolver_float));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->acc_rdgap, sizeof(settings->acc_rdgap));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->acc_reseq, sizeof(settings->acc_reseq));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->acc_resineq, sizeof(settings->acc_resineq));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->acc_kktcompl, sizeof(settings->acc_kktcompl));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->fls_scale, sizeof(settings->fls_scale));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->maxit, sizeof(settings->maxit));
+    hash = FORCESNLPsolver_fnv1a(hash, &settings->max_soc_it, sizeof(settings->max_soc_it));
+    return hash;
+}
+
+/* equal results, whatever the printlevel */
+static int FORCESNLPsolver_settings_equal(const FORCESNLPsolver_settings *a, const FORCESNLPsolver_settings *b)
+{
+    return a->acc_rdgap == b->acc_rdgap && a->acc_reseq == b->acc_reseq && a->acc_resineq == b->acc_resineq && a->acc_kktcompl == b->acc_kktcompl &&
+           a->fls_scale == b->fls_scale && a->maxit == b->maxit && a->max_soc_it == b->max_soc_it;
+}
+
+static solver_int32_default FORCESNLPsolver_cache_find(const FORCESNLPsolver_cache *cache, const FORCESNLPsolver_float *key, const FORCESNLPsolver_settings *settings, solver_int64_unsigned hash)
+{
+    solver_int32_default i = cache->buckets[hash & (solver_int64_unsigned) (cache->nbuckets - 1)];
+    const FORCESNLPsolver_cache_entry *e;
+
+    for( ; i != FORCESNLPsolver_CACHE_NONE; i = e->next )
+    {
+        e = &cache->entries[i];
+        if( e->hash == hash && memcmp(e->key, key, sizeof(e->key)) == 0 && FORCESNLPsolver_settings_equal(&e->settings, settings) )
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+static void FORCESNLPsolver_cache_unlink(FORCESNLPsolver_cache *cache, solver_int32_default i)
+{
+    FORCESNLPsolver_cache_entry *e = &cache->entries[i];
+
+    if( e->newer != FORCESNLPsolver_CACHE_NONE )
+    {
+        cache->entries[e->newer].older = e->older;
+    }
+    else
+    {
+        cache->newest = e->older;
+    }
+    if( e->older != FORCESNLPsolver_CACHE_NONE )
+    {
+        cache->entries[e->older].newer = e->newer;
+    }
+    else
+    {
+        cache->oldest = e->newer;
+    }
+}
+
+/* makes entry i the most recently used */
+static void FORCESNLPsolver_cache_touch(FORCESNLPsolver_cache *cache, solver_int32_default i, int linked)
+{
+    FORCESNLPsolver_cache_entry *e = &cache->entries[i];
+
+    if( linked )
+    {
+        FORCESNLPsolver_cache_unlink(cache, i);
+    }
+    e->newer = FORCESNLPsolver_CACHE_NONE;
+    e->older = cache->newest;
+    if( cache->newest != FORCESNLPsolver_CACHE_NONE )
+    {
+        cache->entries[cache->newest].newer = i;
+    }
+    cache->newest = i;
+    if( cache->oldest == FORCESNLPsolver_CACHE_NONE )
+    {
+        cache->oldest = i;
+    }
+}
+
+/* removes the least recently used entry from its bucket, returns it for reuse */
+static solver_int32_default FORCESNLPsolver_cache_evict(FORCESNLPsolver_cache *cache)
+{
+    solver_int32_default i = cache->oldest;
+    solver_int32_default *link = &cache->buckets[cache->entries[i].hash & (solver_int64_unsigned) (cache->nbuckets - 1)];
+
+    while( *link != i )
+    {
+        link = &cache->entries[*link].next;
+    }
+    *link = cache->entries[i].next;
+    FORCESNLPsolver_cache_unlink(cache, i);
+    cache->stats.evictions++;
+    return i;
+}
+
+FORCESNLPsolver_cache *FORCESNLPsolver_cache_create(size_t bytes)
+{
+    FORCESNLPsolver_cache *cache;
+    size_t capacity = bytes / (sizeof(FORCESNLPsolver_cache_entry) + 2 * sizeof(solver_int32_default));
+    solver_int32_default nbuckets = 1;
+
+    if( capacity < 1 )
+    {
+        return NULL;
+    }
+    if( capacity > (1 << 28) )
+    {
+        capacity = 1 << 28;
+    }
+    while( (size_t) nbuckets < capacity )
+    {
+        nbuckets *= 2;
+    }
+    cache = (FORCESNLPsolver_cache *) malloc(sizeof(FORCESNLPsolver_cache));
+    if( cache == NULL )
+    {
+        return NULL;
+    }
+    cache->entries = (FORCESNLPsolver_cache_entry *) malloc(capacity * sizeof(FORCESNLPsolver_cache_entry));
+    cache->buckets = (solver_int32_default *) malloc(nbuckets * sizeof(solver_int32_default));
+    if( cache->entries == NULL || cache->buckets == NULL )
+    {
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache);
+        return NULL;
+    }
+    FORCESNLPsolver_mutex_init(&cache->lock);
+    cache->nbuckets = nbuckets;
+    cache->stats.capacity = (solver_int32_default) capacity;
+    FORCESNLPsolver_cache_clear(cache);
+    return cache;
+}
+
+void FORCESNLPsolver_cache_destroy(FORCESNLPsolver_cache *cache)
+{
+    if( cache != NULL )
+    {
+        FORCESNLPsolver_mutex_free(&cache->lock);
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache);
+    }
+}
+
+void FORCESNLPsolver_cache_clear(FORCESNLPsolver_cache *cache)
+{
+    solver_int32_default i, capacity;
+
+    FORCESNLPsolver_mutex_lock(&cache->lock);
+    for( i = 0; i < cache->nbuckets; i++ )
+    {
+        cache->buckets[i] = FORCESNLPsolver_CACHE_NONE;
+    }
+    cache->newest = FORCESNLPsolver_CACHE_NONE;
+    cache->oldest = FORCESNLPsolver_CACHE_NONE;
+    capacity = cache->stats.capacity;
+    memset(&cache->stats, 0, sizeof(FORCESNLPsolver_cache_stats));
+    cache->stats.capacity = capacity;
+    FORCESNLPsolver_mutex_unlock(&cache->lock);
+}
+
+void FORCESNLPsolver_cache_get_stats(FORCESNLPsolver_cache *cache, FORCESNLPsolver_cache_stats *stats)
+{
+    FORCESNLPsolver_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    FORCESNLPsolver_mutex_unlock(&cache->lock);
+}
+
+void FORCESNLPsolver_set_cache(FORCESNLPsolver_context *ctx, FORCESNLPsolver_cache *cache)
+{
+    ctx->cache = cache;
+}
+
+/* on a hit copies the stored result into ctx and returns 1; on a miss with
+   FORCESNLPsolver_WARMSTART_NEAREST seeds params.x0 from the optimal entry of
+   least squared distance in the key, and returns 0 */
+static int FORCESNLPsolver_cache_fetch(FORCESNLPsolver_cache *cache, FORCESNLPsolver_context *ctx, solver_int64_unsigned hash)
+{
+    const FORCESNLPsolver_float *key = (const FORCESNLPsolver_float *) &ctx->params + FORCESNLPsolver_CACHE_KEY_FIRST;
+    const FORCESNLPsolver_cache_entry *e;
+    solver_int32_default i, k, nearest = FORCESNLPsolver_CACHE_NONE;
+    double dist, d, best = 0.0;
+
+    FORCESNLPsolver_mutex_lock(&cache->lock);
+    i = FORCESNLPsolver_cache_find(cache, key, &ctx->settings, hash);
+    if( i != FORCESNLPsolver_CACHE_NONE )
+    {
+        e = &cache->entries[i];
+        ctx->output = e->output;
+        ctx->info = e->info;
+        ctx->exitflag = e->exitflag;
+        FORCESNLPsolver_cache_touch(cache, i, 1);
+        cache->stats.hits++;
+        FORCESNLPsolver_metrics_count(cache_hits);
+        FORCESNLPsolver_mutex_unlock(&cache->lock);
+        return 1;
+    }
+    cache->stats.misses++;
+    FORCESNLPsolver_metrics_count(cache_misses);
+    if( ctx->warmstart == FORCESNLPsolver_WARMSTART_NEAREST )
+    {
+        for( i = cache->newest; i != FORCESNLPsolver_CACHE_NONE; i = e->older )
+        {
+            e = &cache->entries[i];
+            if( e->exitflag != FORCESNLPsolver_OPTIMAL )
+            {
+                continue;
+            }
+            dist = 0.0;
+            for( k = 0; k < FORCESNLPsolver_CACHE_KEY_SIZE && (nearest == FORCESNLPsolver_CACHE_NONE || dist < best); k++ )
+            {
+                d = (double) e->key[k] - (double) key[k];
+                dist += d * d;
+            }
+            if( nearest == FORCESNLPsolver_CACHE_NONE || dist < best )
+            {
+                nearest = i;
+                best = dist;
+            }
+        }
+        if( nearest != FORCESNLPsolver_CACHE_NONE )
+        {
+            /* the 61 stage vectors of FORCESNLPsolver_output are contiguous, like x0 */
+            memcpy(ctx->params.x0, &cache->entries[nearest].output, 1464 * sizeof(FORCESNLPsolver_float));
+            cache->stats.seeded++;
+            if( !ctx->warm_valid )
+            {
+                FORCESNLPsolver_metrics_count(warmstarts);
+            }
+        }
+    }
+    FORCESNLPsolver_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+/* stores the result of the solve of ctx, replacing the least recently used entry if full */
+static void FORCESNLPsolver_cache_store(FORCESNLPsolver_cache *cache, const FORCESNLPsolver_context *ctx, solver_int64_unsigned hash)
+{
+    const FORCESNLPsolver_float *key = (const FORCESNLPsolver_float *) &ctx->params + FORCESNLPsolver_CACHE_KEY_FIRST;
+    FORCESNLPsolver_cache_entry *e;
+    solver_int32_default i, *bucket;
+
+    if( ctx->exitflag == FORCESNLPsolver_TIMELIMIT_REACHED )
+    {
+        return;
+    }
+    FORCESNLPsolver_mutex_lock(&cache->lock);
+    /* another context may have stored the same problem meanwhile */
+    i = FORCESNLPsolver_cache_find(cache, key, &ctx->settings, hash);
+    if( i != FORCESNLPsolver_CACHE_NONE )
+    {
+        FORCESNLPsolver_cache_touch(cache, i, 1);
+    }
+    else
+    {
+        if( cache->stats.entries < cache->stats.capacity )
+        {
+            i = cache->stats.entries++;
+        }
+        else
+        {
+            i = FORCESNLPsolver_cache_evict(cache);
+        }
+        e = &cache->entries[i];
+        memcpy(e->key, key, sizeof(e->key));
+        e->settings = ctx->settings;
+        e->hash = hash;
+        bucket = &cache->buckets[hash & (solver_int64_unsigned) (cache->nbuckets - 1)];
+        e->next = *bucket;
+        *bucket = i;
+        FORCESNLPsolver_cache_touch(cache, i, 0);
+    }
+    e = &cache->entries[i];
+    e->output = ctx->output;
+    e->info = ctx->info;
+    e->exitflag = ctx->exitflag;
+    FORCESNLPsolver_mutex_unlock(&cache->lock);
+}
+
+
+/* LOG SINK -------------------------------------------------------------*/
+/* in-memory stream for the solver printout; tmpfile (anonymous, removed on
+ * close) where open_memstream is not available. NULL if neither works. */
+typedef struct FORCESNLPsolver_logstream
+{
+    FILE *fs;
+    char *buf;
+    size_t len;
+
+} FORCESNLPsolver_logstream;
+
+static FILE *FORCESNLPsolver_log_open(FORCESNLPsolver_logstream *ls)
+{
+    ls->buf = NULL;
+    ls->len = 0;
+#if defined(_WIN32)
+    ls->fs = tmpfile();
+#else
+    ls->fs = open_memstream(&ls->buf, &ls->len);
+#endif
+    return ls->fs;
+}
+
+static void FORCESNLPsolver_log_close(FORCESNLPsolver_logstream *ls, FORCESNLPsolver_logfunc func, void *userdata)
+{
+#if defined(_WIN32)
+    char chunk[4096];
+    size_t n;
+#endif
+
+    if( ls->fs == NULL )
+    {
+        return;
+    }
+#if defined(_WIN32)
+    rewind(ls->fs);
+    while( (n = fread(chunk, 1, sizeof(chunk), ls->fs)) > 0 )
+    {
+        func(userdata, chunk, n);
+    }
+    fclose(ls->fs);
+#else
+    fclose(ls->fs);
+    if( ls->len > 0 )
+    {
+        func(userdata, ls->buf, ls->len);
+    }
+    free(ls->buf);
+#endif
+    ls->fs = NULL;
+}
+
+
+/* SOLVE ----------------------------------------------------------------*/
+/* the cache of ctx if its solves use it: the key has no time limit or
+   derivative reuse, and both change the result */
+static FORCESNLPsolver_cache *FORCESNLPsolver_cache_used(const FORCESNLPsolver_context *ctx)
+{
+    return ctx->timelimit > 0 || ctx->lazy != NULL ? NULL : ctx->cache;
+}
+
+solver_int32_default FORCESNLPsolver_solve_ctx(FORCESNLPsolver_context *ctx)
+{
+    FORCESNLPsolver_logstream ls;
+    FILE *fs = ctx->fs;
+    FORCESNLPsolver_cache *cache = FORCESNLPsolver_cache_used(ctx);
+    solver_int64_unsigned hash = 0;
+    int warm;
+
+    warm = FORCESNLPsolver_apply_warmstart(ctx);
+    if( cache != NULL )
+    {
+        hash = FORCESNLPsolver_cache_hash((const FORCESNLPsolver_float *) &ctx->params + FORCESNLPsolver_CACHE_KEY_FIRST, &ctx->settings);
+        if( FORCESNLPsolver_cache_fetch(cache, ctx, hash) )
+        {
+            /* no sweeps ran; the profile only counts solves that did */
+            if( ctx->trace != NULL )
+            {
+                ctx->trace->count = 0;
+            }
+            FORCESNLPsolver_store_warmstart(ctx);
+            return ctx->exitflag;
+        }
+    }
+    if( warm )
+    {
+        FORCESNLPsolver_metrics_count(warmstarts);
+    }
+    if( ctx->logfunc != NULL )
+    {
+        fs = FORCESNLPsolver_log_open(&ls);
+    }
+
+    ctx->exitflag = FORCESNLPsolver_core_solve(&ctx->params, &ctx->output, &ctx->info, fs, ctx->extfunc, ctx);
+
+    if( ctx->logfunc != NULL )
+    {
+        FORCESNLPsolver_log_close(&ls, ctx->logfunc, ctx->loguser);
+    }
+    if( cache != NULL )
+    {
+        FORCESNLPsolver_cache_store(cache, ctx, hash);
+    }
+    FORCESNLPsolver_store_warmstart(ctx);
+
+    return ctx->exitflag;
+}
+
+
+/* COARSE TO FINE -------------------------------------------------------*/
+/* runs the coarse solve of ctx->params, returns its exitflag; ctx->params.x0
+ * is replaced only if it ended OPTIMAL */
+static solver_int32_default FORCESNLPsolver_coarse_seed(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_coarse *coarse)
+{
+    solver_int32_default nc = coarse->nstages, exitflag, i, j, src;
+    FORCESNLPsolver_float *params, *output, *stageparams;
+
+    params = (FORCESNLPsolver_float *) malloc(((size_t) nc * (24 + 41 + 24) + 16 + 11) * sizeof(FORCESNLPsolver_float));
+    if( params == NULL )
+    {
+        return FORCESNLPsolver_CANCELLED;
+    }
+    output = params + (size_t) nc * (24 + 41) + 16 + 11;
+
+    /* x0, xinit, xfinal and all_parameters of the coarse solver */
+    FORCESNLPsolver_resample_stages(ctx->params.x0, 61, params, nc, 24);
+    memcpy(params + (size_t) nc * 24, ctx->params.xinit, 16 * sizeof(FORCESNLPsolver_float));
+    memcpy(params + (size_t) nc * 24 + 16, ctx->params.xfinal, 11 * sizeof(FORCESNLPsolver_float));
+    stageparams = params + (size_t) nc * 24 + 16 + 11;
+    FORCESNLPsolver_resample_stages(ctx->params.all_parameters, 61, stageparams, nc, 41);
+    if( coarse->interpolate != NULL )
+    {
+        /* the others from the fine stage nearest in time */
+        for( j = 0; j < nc; j++ )
+        {
+            src = (j * 60 + (nc - 1) / 2) / (nc - 1);
+            for( i = 0; i < 41; i++ )
+            {
+                if( !coarse->interpolate[i] )
+                {
+                    stageparams[j * 41 + i] = ctx->params.all_parameters[src * 41 + i];
+                }
+            }
+        }
+    }
+
+    exitflag = coarse->solve(coarse->userdata, params, output);
+    if( exitflag == FORCESNLPsolver_OPTIMAL )
+    {
+        FORCESNLPsolver_resample_stages(output, nc, ctx->params.x0, 61, 24);
+    }
+    free(params);
+    return exitflag;
+}
+
+solver_int32_default FORCESNLPsolver_solve_coarse_to_fine(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_coarse *coarse, solver_int32_default *coarse_exitflag)
+{
+    solver_int32_default exitflag = FORCESNLPsolver_CANCELLED;
+
+    if( coarse->nstages < 2 )
+    {
+        return -1;
+    }
+    /* a stored warm start, or the nearest cached solution, would replace its x0 */
+    if( (!ctx->warm_valid || ctx->warmstart == FORCESNLPsolver_WARMSTART_OFF) &&
+        !(ctx->warmstart == FORCESNLPsolver_WARMSTART_NEAREST && FORCESNLPsolver_cache_used(ctx) != NULL) )
+    {
+        exitflag = FORCESNLPsolver_coarse_seed(ctx, coarse);
+    }
+    if( coarse_exitflag != NULL )
+    {
+        *coarse_exitflag = exitflag;
+    }
+    return FORCESNLPsolver_solve_ctx(ctx);
+}
+
+
+/* ASYNCHRONOUS SOLVES --------------------------------------------------*/
+struct FORCESNLPsolver_pool
+{
+    FORCESNLPsolver_thread *threads;
+    solver_int32_default nthreads;
+
+    /* submitted contexts not yet started, oldest first */
+    FORCESNLPsolver_context *first;
+    FORCESNLPsolver_context *last;
+
+    /* guards the queue, stop and the pending flags of the submitted contexts */
+    FORCESNLPsolver_mutex lock;
+
+    /* signalled on a new job, and on a finished one */
+    FORCESNLPsolver_cond work;
+    FORCESNLPsolver_cond done;
+
+    int stop;
+};
+
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_pool_worker)
+{
+    FORCESNLPsolver_pool *pool = (FORCESNLPsolver_pool *) arg;
+    FORCESNLPsolver_context *ctx;
+
+    FORCESNLPsolver_mutex_lock(&pool->lock);
+    for( ;; )
+    {
+        while( pool->first == NULL && !pool->stop )
+        {
+            FORCESNLPsolver_cond_wait(&pool->work, &pool->lock);
+        }
+        if( pool->first == NULL )
+        {
+            break;
+        }
+        ctx = pool->first;
+        pool->first = ctx->nextjob;
+        if( pool->first == NULL )
+        {
+            pool->last = NULL;
+        }
+        FORCESNLPsolver_mutex_unlock(&pool->lock);
+
+        FORCESNLPsolver_solve_ctx(ctx);
+        if( ctx->done != NULL )
+        {
+            ctx->done(ctx->doneuser, ctx);
+        }
+
+        FORCESNLPsolver_mutex_lock(&pool->lock);
+        ctx->pending = 0;
+        FORCESNLPsolver_cond_broadcast(&pool->done);
+    }
+    FORCESNLPsolver_mutex_unlock(&pool->lock);
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+FORCESNLPsolver_pool *FORCESNLPsolver_pool_create(solver_int32_default nthreads)
+{
+    FORCESNLPsolver_pool *pool = (FORCESNLPsolver_pool *) malloc(sizeof(FORCESNLPsolver_pool));
+
+    if( pool == NULL )
+    {
+        return NULL;
+    }
+    if( nthreads <= 0 )
+    {
+        nthreads = FORCESNLPsolver_num_processors();
+    }
+    memset(pool, 0, sizeof(FORCESNLPsolver_pool));
+    pool->threads = (FORCESNLPsolver_thread *) malloc(nthreads * sizeof(FORCESNLPsolver_thread));
+    if( pool->threads == NULL )
+    {
+        free(pool);
+        return NULL;
+    }
+    FORCESNLPsolver_mutex_init(&pool->lock);
+    FORCESNLPsolver_cond_init(&pool->work);
+    FORCESNLPsolver_cond_init(&pool->done);
+    for( pool->nthreads = 0; pool->nthreads < nthreads; pool->nthreads++ )
+    {
+        if( FORCESNLPsolver_thread_start(&pool->threads[pool->nthreads], FORCESNLPsolver_pool_worker, pool) != 0 )
+        {
+            break;
+        }
+    }
+    /* fewer threads than asked for still work, none do not */
+    if( pool->nthreads == 0 )
+    {
+        FORCESNLPsolver_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void FORCESNLPsolver_pool_destroy(FORCESNLPsolver_pool *pool)
+{
+    solver_int32_default i;
+
+    if( pool == NULL )
+    {
+        return;
+    }
+    FORCESNLPsolver_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    FORCESNLPsolver_cond_broadcast(&pool->work);
+    FORCESNLPsolver_mutex_unlock(&pool->lock);
+    for( i = 0; i < pool->nthreads; i++ )
+    {
+        FORCESNLPsolver_thread_join(pool->threads[i]);
+    }
+    FORCESNLPsolver_cond_free(&pool->work);
+    FORCESNLPsolver_cond_free(&pool->done);
+    FORCESNLPsolver_mutex_free(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+solver_int32_default FORCESNLPsolver_submit(FORCESNLPsolver_pool *pool, FORCESNLPsolver_context *ctx, FORCESNLPsolver_donefunc done, void *userdata)
+{
+    /* still submitted, not yet collected by poll or wait */
+    if( ctx->pool != NULL )
+    {
+        return -1;
+    }
+    ctx->pool = pool;
+    ctx->pending = 1;
+    ctx->done = done;
+    ctx->doneuser = userdata;
+    ctx->nextjob = NULL;
+
+    FORCESNLPsolver_mutex_lock(&pool->lock);
+    if( pool->last != NULL )
+    {
+        pool->last->nextjob = ctx;
+    }
+    else
+    {
+        pool->first = ctx;
+    }
+    pool->last = ctx;
+    FORCESNLPsolver_cond_broadcast(&pool->work);
+    FORCESNLPsolver_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+solver_int32_default FORCESNLPsolver_poll(FORCESNLPsolver_context *ctx)
+{
+    FORCESNLPsolver_pool *pool = ctx->pool;
+    solver_int32_default finished;
+
+    if( pool == NULL )
+    {
+        return 1;
+    }
+    FORCESNLPsolver_mutex_lock(&pool->lock);
+    finished = !ctx->pending;
+    FORCESNLPsolver_mutex_unlock(&pool->lock);
+    if( finished )
+    {
+        ctx->pool = NULL;
+    }
+    return finished;
+}
+
+solver_int32_default FORCESNLPsolver_wait(FORCESNLPsolver_context *ctx)
+{
+    FORCESNLPsolver_pool *pool = ctx->pool;
+
+    if( pool != NULL )
+    {
+        FORCESNLPsolver_mutex_lock(&pool->lock);
+        while( ctx->pending )
+        {
+            FORCESNLPsolver_cond_wait(&pool->done, &pool->lock);
+        }
+        FORCESNLPsolver_mutex_unlock(&pool->lock);
+        ctx->pool = NULL;
+    }
+    return ctx->exitflag;
+}
+
+
+/* BATCH SOLVE ----------------------------------------------------------*/
+typedef struct FORCESNLPsolver_batch
+{
+    FORCESNLPsolver_params *params;
+    FORCESNLPsolver_output *outputs;
+    FORCESNLPsolver_info *infos;
+    solver_int32_default *exitflags;
+    FORCESNLPsolver_extfunc extfunc;
+    solver_int32_default n;
+
+    /* shared parameters and per-solve slices, FORCESNLPsolver_solve_batch_template only */
+    const FORCESNLPsolver_params *tmpl;
+    const FORCESNLPsolver_float *overrides;
+    solver_int32_default first, len, stride, nblocks;
+
+    /* perturbations of tmpl by +step along directions into outputs and, unless
+       minus is NULL (one-sided), by -step into minus (solves n/2 and up),
+       FORCESNLPsolver_sensitivity only */
+    const FORCESNLPsolver_float *directions;
+    FORCESNLPsolver_float step;
+    FORCESNLPsolver_output *minus;
+    const FORCESNLPsolver_context *options;
+
+    /* interleaved parameters and outputs, FORCESNLPsolver_solve_batch_lanes only */
+    const FORCESNLPsolver_float *laneparams;
+    FORCESNLPsolver_float *laneoutputs;
+
+    /* cancellation and pinning, NULL if neither */
+    const FORCESNLPsolver_batch_control *control;
+
+    /* run by every thread */
+    FORCESNLPsolver_thread_func worker;
+
+    /* next solve to hand out and number of threads pinned so far, guarded by lock */
+    solver_int32_default next;
+    solver_int32_default npinned;
+    FORCESNLPsolver_mutex lock;
+
+} FORCESNLPsolver_batch;
+
+/* index of the next solve to run, n when all are handed out; solves the
+   control cancels are skipped here */
+static solver_int32_default FORCESNLPsolver_batch_next(FORCESNLPsolver_batch *batch)
+{
+    const FORCESNLPsolver_batch_control *control = batch->control;
+    solver_int32_default k;
+
+    for( ;; )
+    {
+        FORCESNLPsolver_mutex_lock(&batch->lock);
+        k = batch->next < batch->n ? batch->next++ : batch->n;
+        FORCESNLPsolver_mutex_unlock(&batch->lock);
+        if( k == batch->n || control == NULL || control->cancel == NULL || !control->cancel(control->canceluser, k) )
+        {
+            return k;
+        }
+        batch->exitflags[k] = FORCESNLPsolver_CANCELLED;
+        if( batch->infos != NULL )
+        {
+            memset(&batch->infos[k], 0, sizeof(FORCESNLPsolver_info));
+        }
+    }
+}
+
+/* pins the calling thread if the control asks for it, returns nonzero if it did */
+static int FORCESNLPsolver_batch_pin(FORCESNLPsolver_batch *batch, FORCESNLPsolver_affinity *saved)
+{
+    solver_int32_default index;
+
+    if( batch->control == NULL || !batch->control->pin )
+    {
+        return 0;
+    }
+    FORCESNLPsolver_mutex_lock(&batch->lock);
+    index = batch->npinned++;
+    FORCESNLPsolver_mutex_unlock(&batch->lock);
+    return FORCESNLPsolver_pin_thread(index, saved) == 0;
+}
+
+/* helper threads of a batch; they end with the batch, so their affinity is not restored */
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_batch_thread)
+{
+    FORCESNLPsolver_batch *batch = (FORCESNLPsolver_batch *) arg;
+    FORCESNLPsolver_affinity saved;
+
+    FORCESNLPsolver_batch_pin(batch, &saved);
+    batch->worker(batch);
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_batch_worker)
+{
+    FORCESNLPsolver_batch *batch = (FORCESNLPsolver_batch *) arg;
+    FORCESNLPsolver_info info;
+    solver_int32_default k;
+
+    while( (k = FORCESNLPsolver_batch_next(batch)) < batch->n )
+    {
+        /* solve in place, no staging through a context needed; infos may be NULL */
+        batch->exitflags[k] = FORCESNLPsolver_core_solve(&batch->params[k], &batch->outputs[k], batch->infos != NULL ? &batch->infos[k] : &info, NULL, batch->extfunc, NULL);
+    }
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_template_worker)
+{
+    FORCESNLPsolver_batch *batch = (FORCESNLPsolver_batch *) arg;
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_info info;
+    const FORCESNLPsolver_float *values;
+    solver_int32_default j, k;
+
+    /* one private copy of the shared parameters per worker, only the slices change */
+    memcpy(&params, batch->tmpl, sizeof(FORCESNLPsolver_params));
+    while( (k = FORCESNLPsolver_batch_next(batch)) < batch->n )
+    {
+        values = batch->overrides + (size_t) k * batch->len * batch->nblocks;
+        for( j = 0; j < batch->nblocks; j++ )
+        {
+            memcpy(params.all_parameters + batch->first + j * batch->stride, values + j * batch->len, batch->len * sizeof(FORCESNLPsolver_float));
+        }
+        batch->exitflags[k] = FORCESNLPsolver_core_solve(&params, &batch->outputs[k], batch->infos != NULL ? &batch->infos[k] : &info, NULL, batch->extfunc, NULL);
+    }
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_sensitivity_worker)
+{
+    FORCESNLPsolver_batch *batch = (FORCESNLPsolver_batch *) arg;
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_info info;
+    const FORCESNLPsolver_float *dir;
+    FORCESNLPsolver_float step;
+    FORCESNLPsolver_output *output;
+    solver_int32_default i, j, k, ndir = batch->minus != NULL ? batch->n / 2 : batch->n;
+
+    while( (k = FORCESNLPsolver_batch_next(batch)) < batch->n )
+    {
+        /* tmpl starts from the nominal solution, so each solve only has to follow the perturbation */
+        j = k % ndir;
+        step = k < ndir ? batch->step : -batch->step;
+        output = k < ndir ? &batch->outputs[j] : &batch->minus[j];
+        memcpy(&params, batch->tmpl, sizeof(FORCESNLPsolver_params));
+        dir = batch->directions + (size_t) j * 2501;
+        for( i = 0; i < 2501; i++ )
+        {
+            params.all_parameters[i] += step * dir[i];
+        }
+        batch->exitflags[k] = FORCESNLPsolver_core_solve(&params, output, &info, NULL, batch->extfunc, batch->options);
+    }
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+FORCESNLPsolver_THREAD_FUNC(FORCESNLPsolver_lanes_worker)
+{
+    FORCESNLPsolver_batch *batch = (FORCESNLPsolver_batch *) arg;
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_output output;
+    FORCESNLPsolver_info info;
+    FORCESNLPsolver_float *p = (FORCESNLPsolver_float *) &params, *o = (FORCESNLPsolver_float *) &output;
+    size_t n = (size_t) batch->n, j;
+    solver_int32_default k;
+
+    /* lane k is gathered into the layout of the core and scattered back */
+    while( (k = FORCESNLPsolver_batch_next(batch)) < batch->n )
+    {
+        for( j = 0; j < 3992; j++ )
+        {
+            p[j] = batch->laneparams[j * n + k];
+        }
+        batch->exitflags[k] = FORCESNLPsolver_core_solve(&params, &output, batch->infos != NULL ? &batch->infos[k] : &info, NULL, batch->extfunc, NULL);
+        for( j = 0; j < 1464; j++ )
+        {
+            batch->laneoutputs[j * n + k] = o[j];
+        }
+    }
+
+    FORCESNLPsolver_THREAD_RETURN;
+}
+
+/* runs worker on nthreads threads until batch is done, returns the number of OPTIMAL solves */
+static solver_int32_default FORCESNLPsolver_batch_run(FORCESNLPsolver_batch *batch, FORCESNLPsolver_thread_func worker, solver_int32_default nthreads)
+{
+    FORCESNLPsolver_thread *threads = NULL;
+    FORCESNLPsolver_affinity saved;
+    solver_int32_default i, started = 0, noptimal = 0;
+    int pinned;
+
+    if( nthreads <= 0 )
+    {
+        nthreads = FORCESNLPsolver_num_processors();
+    }
+    if( nthreads > batch->n )
+    {
+        nthreads = batch->n;
+    }
+    batch->next = 0;
+    batch->npinned = 0;
+    batch->worker = worker;
+    FORCESNLPsolver_mutex_init(&batch->lock);
+
+    /* the calling thread is worker 0; if helpers cannot be started it does all the work */
+    if( nthreads > 1 )
+    {
+        threads = (FORCESNLPsolver_thread *) malloc((nthreads - 1) * sizeof(FORCESNLPsolver_thread));
+    }
+    if( threads != NULL )
+    {
+        for( i = 0; i < nthreads - 1; i++ )
+        {
+            if( FORCESNLPsolver_thread_start(&threads[started], FORCESNLPsolver_batch_thread, batch) != 0 )
+            {
+                break;
+            }
+            started++;
+        }
+    }
+    pinned = FORCESNLPsolver_batch_pin(batch, &saved);
+    worker(batch);
+    if( pinned )
+    {
+        FORCESNLPsolver_unpin_thread(&saved);
+    }
+    for( i = 0; i < started; i++ )
+    {
+        FORCESNLPsolver_thread_join(threads[i]);
+    }
+    free(threads);
+    FORCESNLPsolver_mutex_free(&batch->lock);
+
+    for( i = 0; i < batch->n; i++ )
+    {
+        if( batch->exitflags[i] == FORCESNLPsolver_OPTIMAL )
+        {
+            noptimal++;
+        }
+    }
+    return noptimal;
+}
+
+solver_int32_default FORCESNLPsolver_solve_batch(FORCESNLPsolver_params *params, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc)
+{
+    return FORCESNLPsolver_solve_batch_control(params, outputs, infos, exitflags, n, nthreads, extfunc, NULL);
+}
+
+solver_int32_default FORCESNLPsolver_solve_batch_control(FORCESNLPsolver_params *params, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc,
+                                                         const FORCESNLPsolver_batch_control *control)
+{
+    FORCESNLPsolver_batch batch;
+
+    if( n <= 0 )
+    {
+        return 0;
+    }
+    memset(&batch, 0, sizeof(batch));
+    batch.params = params;
+    batch.outputs = outputs;
+    batch.infos = infos;
+    batch.exitflags = exitflags;
+    batch.extfunc = extfunc;
+    batch.n = n;
+    batch.control = control;
+    return FORCESNLPsolver_batch_run(&batch, FORCESNLPsolver_batch_worker, nthreads);
+}
+
+solver_int32_default FORCESNLPsolver_solve_batch_template(const FORCESNLPsolver_params *tmpl, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default nblocks, const FORCESNLPsolver_float *overrides, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc)
+{
+    return FORCESNLPsolver_solve_batch_template_control(tmpl, first, len, stride, nblocks, overrides, outputs, infos, exitflags, n, nthreads, extfunc, NULL);
+}
+
+solver_int32_default FORCESNLPsolver_solve_batch_template_control(const FORCESNLPsolver_params *tmpl, solver_int32_default first, solver_int32_default len, solver_int32_default stride, solver_int32_default nblocks, const FORCESNLPsolver_float *overrides, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc,
+                                                                  const FORCESNLPsolver_batch_control *control)
+{
+    FORCESNLPsolver_batch batch;
+
+    if( n <= 0 )
+    {
+        return 0;
+    }
+    if( !FORCESNLPsolver_slice_fits(first, len, stride, nblocks) )
+    {
+        return -1;
+    }
+    memset(&batch, 0, sizeof(batch));
+    batch.outputs = outputs;
+    batch.infos = infos;
+    batch.exitflags = exitflags;
+    batch.extfunc = extfunc;
+    batch.n = n;
+    batch.tmpl = tmpl;
+    batch.overrides = overrides;
+    batch.first = first;
+    batch.len = len;
+    batch.stride = stride;
+    batch.nblocks = nblocks;
+    batch.control = control;
+    return FORCESNLPsolver_batch_run(&batch, FORCESNLPsolver_template_worker, nthreads);
+}
+
+/* backend of the lanes batches, valid if FORCESNLPsolver_backend_set */
+static FORCESNLPsolver_batch_backend FORCESNLPsolver_backend;
+static int FORCESNLPsolver_backend_set = 0;
+
+void FORCESNLPsolver_set_batch_backend(const FORCESNLPsolver_batch_backend *backend)
+{
+    FORCESNLPsolver_backend_set = 0;
+    if( backend != NULL && backend->solve_lanes != NULL )
+    {
+        FORCESNLPsolver_backend = *backend;
+        FORCESNLPsolver_backend_set = 1;
+    }
+}
+
+const FORCESNLPsolver_batch_backend *FORCESNLPsolver_get_batch_backend(void)
+{
+    return FORCESNLPsolver_backend_set ? &FORCESNLPsolver_backend : NULL;
+}
+
+solver_int32_default FORCESNLPsolver_solve_batch_lanes(const FORCESNLPsolver_float *params, FORCESNLPsolver_float *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, solver_int32_default n, solver_int32_default nthreads, FORCESNLPsolver_extfunc extfunc,
+                                                       const FORCESNLPsolver_batch_control *control)
+{
+    FORCESNLPsolver_batch batch;
+    FORCESNLPsolver_info *backendinfos;
+    solver_int32_default noptimal, k;
+
+    if( n <= 0 )
+    {
+        return 0;
+    }
+    if( FORCESNLPsolver_backend_set && n >= FORCESNLPsolver_backend.minbatch && (control == NULL || control->cancel == NULL) )
+    {
+        /* the backend always gets infos, the metrics need them */
+        backendinfos = infos != NULL ? infos : (FORCESNLPsolver_info *) malloc((size_t) n * sizeof(FORCESNLPsolver_info));
+        noptimal = backendinfos == NULL ? -1 : FORCESNLPsolver_backend.solve_lanes(FORCESNLPsolver_backend.userdata, params, outputs, backendinfos, exitflags, n);
+        if( noptimal >= 0 )
+        {
+            for( k = 0; k < n; k++ )
+            {
+                FORCESNLPsolver_metrics_solve(exitflags[k], &backendinfos[k]);
+            }
+        }
+        if( backendinfos != infos )
+        {
+            free(backendinfos);
+        }
+        if( noptimal >= 0 )
+        {
+            return noptimal;
+        }
+    }
+    memset(&batch, 0, sizeof(batch));
+    batch.laneparams = params;
+    batch.laneoutputs = outputs;
+    batch.infos = infos;
+    batch.exitflags = exitflags;
+    batch.extfunc = extfunc;
+    batch.n = n;
+    batch.control = control;
+    return FORCESNLPsolver_batch_run(&batch, FORCESNLPsolver_lanes_worker, nthreads);
+}
+
+
+/* SENSITIVITIES --------------------------------------------------------*/
+/* settings of ctx with the tolerances tightened for a perturbation of step, silent */
+static void FORCESNLPsolver_sensitivity_settings(FORCESNLPsolver_settings *settings, FORCESNLPsolver_float step)
+{
+    FORCESNLPsolver_float tol = (FORCESNLPsolver_float) (FORCESNLPsolver_SENSITIVITY_TOL_RATIO * step);
+
+    if( settings->acc_rdgap > tol )
+    {
+        settings->acc_rdgap = tol;
+    }
+    if( settings->acc_reseq > tol )
+    {
+        settings->acc_reseq = tol;
+    }
+    if( settings->acc_resineq > tol )
+    {
+        settings->acc_resineq = tol;
+    }
+    if( settings->acc_kktcompl > tol )
+    {
+        settings->acc_kktcompl = tol;
+    }
+    settings->printlevel = 0;
+}
+
+solver_int32_default FORCESNLPsolver_sensitivity(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_float *directions, solver_int32_default ndir, FORCESNLPsolver_float step, solver_int32_default onesided, FORCESNLPsolver_float *dx, solver_int32_default nthreads)
+{
+    FORCESNLPsolver_batch batch;
+    FORCESNLPsolver_params *tmpl;
+    FORCESNLPsolver_context *options;
+    FORCESNLPsolver_output *minus, *nominal;
+    FORCESNLPsolver_info info;
+    solver_int32_default *exitflags;
+    const FORCESNLPsolver_float *low;
+    FORCESNLPsolver_float *row;
+    solver_int32_default i, k, noptimal = 0, exitflag;
+
+    if( ctx->exitflag != FORCESNLPsolver_OPTIMAL || ndir < 0 )
+    {
+        return FORCESNLPsolver_SENSITIVITY_NOT_OPTIMAL;
+    }
+    if( ndir == 0 )
+    {
+        return 0;
+    }
+    if( step <= 0 )
+    {
+        step = (FORCESNLPsolver_float) (sizeof(FORCESNLPsolver_float) < sizeof(double) ? FORCESNLPsolver_SENSITIVITY_STEP_SINGLE : FORCESNLPsolver_SENSITIVITY_STEP);
+    }
+    tmpl = (FORCESNLPsolver_params *) malloc(sizeof(FORCESNLPsolver_params));
+    options = (FORCESNLPsolver_context *) malloc(sizeof(FORCESNLPsolver_context));
+    nominal = (FORCESNLPsolver_output *) malloc(sizeof(FORCESNLPsolver_output));
+    minus = onesided ? NULL : (FORCESNLPsolver_output *) malloc((size_t) ndir * sizeof(FORCESNLPsolver_output));
+    exitflags = (solver_int32_default *) malloc((onesided ? 1 : 2) * (size_t) ndir * sizeof(solver_int32_default));
+    if( tmpl == NULL || options == NULL || nominal == NULL || (minus == NULL && !onesided) || exitflags == NULL )
+    {
+        free(tmpl);
+        free(options);
+        free(nominal);
+        free(minus);
+        free(exitflags);
+        return FORCESNLPsolver_SENSITIVITY_NO_MEMORY;
+    }
+    memcpy(tmpl, &ctx->params, sizeof(FORCESNLPsolver_params));
+    memcpy(tmpl->x0, &ctx->output, 1464 * sizeof(FORCESNLPsolver_float));
+
+    /* the settings of ctx at tightened tolerances, but no time limit, profile
+       or trace: those are per solve of ctx */
+    FORCESNLPsolver_init(options, ctx->extfunc);
+    options->settings = ctx->settings;
+    FORCESNLPsolver_sensitivity_settings(&options->settings, step);
+
+    /* the nominal point again at these tolerances; the perturbed solves all
+       start from its solution, so where they stop differs by the perturbation
+       and not by where they started */
+    exitflag = FORCESNLPsolver_core_solve(tmpl, nominal, &info, NULL, ctx->extfunc, options);
+    if( exitflag == FORCESNLPsolver_OPTIMAL )
+    {
+        memcpy(tmpl->x0, nominal, 1464 * sizeof(FORCESNLPsolver_float));
+
+        /* solve k < ndir writes its output straight into row k of dx, same layout */
+        memset(&batch, 0, sizeof(batch));
+        batch.outputs = (FORCESNLPsolver_output *) dx;
+        batch.minus = minus;
+        batch.exitflags = exitflags;
+        batch.extfunc = ctx->extfunc;
+        batch.n = onesided ? ndir : 2 * ndir;
+        batch.tmpl = tmpl;
+        batch.directions = directions;
+        batch.step = step;
+        batch.options = options;
+        FORCESNLPsolver_batch_run(&batch, FORCESNLPsolver_sensitivity_worker, nthreads);
+
+        for( k = 0; k < ndir; k++ )
+        {
+            row = dx + (size_t) k * 1464;
+            /* one-sided: against the nominal solution, which is solved at the same tolerances */
+            low = (const FORCESNLPsolver_float *) (onesided ? nominal : &minus[k]);
+            if( exitflags[k] == FORCESNLPsolver_OPTIMAL && (onesided || exitflags[ndir + k] == FORCESNLPsolver_OPTIMAL) )
+            {
+                for( i = 0; i < 1464; i++ )
+                {
+                    row[i] = (row[i] - low[i]) / (onesided ? step : 2 * step);
+                }
+                noptimal++;
+            }
+            else
+            {
+                for( i = 0; i < 1464; i++ )
+                {
+                    row[i] = (FORCESNLPsolver_float) NAN;
+                }
+            }
+        }
+    }
+    free(tmpl);
+    free(options);
+    free(nominal);
+    free(minus);
+    free(exitflags);
+    return exitflag == FORCESNLPsolver_OPTIMAL ? noptimal : FORCESNLPsolver_SENSITIVITY_NOMINAL_FAILED;
+}
+
+solver_int32_default FORCESNLPsolver_sensitivity_fd(FORCESNLPsolver_context *ctx, const FORCESNLPsolver_float *lossgrad, const FORCESNLPsolver_float *directions, solver_int32_default ndir, FORCESNLPsolver_float step, solver_int32_default onesided, FORCESNLPsolver_float *grad, solver_int32_default nthreads)
+{
+    FORCESNLPsolver_float *dx;
+    solver_int32_default i, k, noptimal;
+    double sum;
+
+    if( ndir <= 0 )
+    {
+        return FORCESNLPsolver_sensitivity(ctx, directions, ndir, step, onesided, NULL, nthreads);
+    }
+    dx = (FORCESNLPsolver_float *) malloc((size_t) ndir * 1464 * sizeof(FORCESNLPsolver_float));
+    if( dx == NULL )
+    {
+        return FORCESNLPsolver_SENSITIVITY_NO_MEMORY;
+    }
+    noptimal = FORCESNLPsolver_sensitivity(ctx, directions, ndir, step, onesided, dx, nthreads);
+    for( k = 0; k < ndir && noptimal >= 0; k++ )
+    {
+        sum = 0.0;
+        for( i = 0; i < 1464; i++ )
+        {
+            sum += (double) lossgrad[i] * (double) dx[(size_t) k * 1464 + i];
+        }
+        grad[k] = (FORCESNLPsolver_float) sum;
+    }
+    free(dx);
+    return noptimal;
+}
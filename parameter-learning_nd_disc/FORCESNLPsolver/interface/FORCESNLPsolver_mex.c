@@ -25,42 +25,924 @@ jurisdiction in case of any dispute.
 #include "mex.h"
 #include "math.h"
 #include "../include/FORCESNLPsolver.h"
+#include "../include/FORCESNLPsolver_context.h"
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 
 
 /* copy functions */
-void copyCArrayToM(double *src, double *dest, solver_int32_default dim) 
+void copyCArrayToM(FORCESNLPsolver_float *src, double *dest, solver_int32_default dim) 
 {
     while (dim--) 
 	{
         *dest++ = (double)*src++;
     }
 }
-void copyMArrayToC(double *src, double *dest, solver_int32_default dim) 
+void copyMArrayToC(double *src, FORCESNLPsolver_float *dest, solver_int32_default dim) 
 {
     while (dim--) 
 	{
-        *dest++ = (double) (*src++) ;
+        *dest++ = (FORCESNLPsolver_float) (*src++) ;
     }
 }
 
+/* elements of a double array as FORCESNLPsolver_float, converted into mxCalloc memory
+   in single precision builds; release with freeSolverArray */
+static FORCESNLPsolver_float *getSolverArray(const mxArray *value)
+{
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+	FORCESNLPsolver_float *dest = (FORCESNLPsolver_float *) mxCalloc(mxGetNumberOfElements(value), sizeof(FORCESNLPsolver_float));
+	copyMArrayToC(mxGetPr(value), dest, (solver_int32_default)mxGetNumberOfElements(value));
+	return dest;
+#else
+	return mxGetPr(value);
+#endif
+}
+
+static void freeSolverArray(FORCESNLPsolver_float *values)
+{
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+	mxFree(values);
+#endif
+}
+
 
 extern void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
-FORCESNLPsolver_extfunc pt2function = &FORCESNLPsolver_casadi2forces;
+FORCESNLPsolver_extfunc pt2function = &FORCESNLPsolver_casadi2forces;
+
+
+/* returns PARAMS.(name) of size [M x 1] or [M x K]; stride is 0 for a single column */
+static double *getBatchField(const mxArray *PARAMS, const char *name, mwSize M, mwSize K, mwSize *stride)
+{
+	mxArray *par = mxGetField(PARAMS, 0, name);
+	if( par == NULL )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:batch", "PARAMS.%s not found", name);
+	}
+	if( !mxIsDouble(par) || mxGetM(par) != M || (mxGetN(par) != 1 && mxGetN(par) != K) )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:batch", "PARAMS.%s must be a double of size [%d x 1] or [%d x %d]", name, (int)M, (int)M, (int)K);
+	}
+	*stride = mxGetN(par) == 1 ? 0 : M;
+	return mxGetPr(par);
+}
+
+/* batch results to matlab arrays */
+static void batchResults(solver_int32_default nlhs, mxArray *plhs[], mwSize K, solver_int32_default packed, FORCESNLPsolver_output *outputs, FORCESNLPsolver_info *infos, solver_int32_default *exitflags, const solver_int8_default **outputnames, const solver_int8_default **infofields)
+{
+	mwSize k;
+	mwSize dims[3] = {24, 61, 0};
+	solver_int32_default i;
+	double *pr[10];
+	mxArray *outvar;
+
+	/* copy output to matlab arrays, stage s of problem k goes to column k of field s,
+	   or to (:,s,k) of one 24 x 61 x K array if packed */
+	if( packed )
+	{
+		dims[2] = K;
+		plhs[0] = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+		copyCArrayToM( (FORCESNLPsolver_float *) outputs, mxGetPr(plhs[0]), (solver_int32_default)(1464*K));
+	}
+	else
+	{
+		plhs[0] = mxCreateStructMatrix(1, 1, 61, outputnames);
+		for( i=0; i<61; i++ )
+		{
+			outvar = mxCreateDoubleMatrix(24, K, mxREAL);
+			for( k=0; k<K; k++ )
+			{
+				/* the 61 stage vectors of FORCESNLPsolver_output are contiguous */
+				copyCArrayToM( (FORCESNLPsolver_float *) &outputs[k] + 24*i, mxGetPr(outvar) + 24*k, 24);
+			}
+			mxSetFieldByNumber(plhs[0], 0, i, outvar);
+		}
+	}
+
+	/* copy exitflags */
+	if( nlhs > 1 )
+	{
+		plhs[1] = mxCreateDoubleMatrix(1, K, mxREAL);
+		for( k=0; k<K; k++ )
+		{
+			mxGetPr(plhs[1])[k] = (double)exitflags[k];
+		}
+	}
+
+	/* copy info struct, one column per problem */
+	if( nlhs > 2 )
+	{
+		plhs[2] = mxCreateStructMatrix(1, 1, 10, infofields);
+		for( i=0; i<10; i++ )
+		{
+			outvar = mxCreateDoubleMatrix(1, K, mxREAL);
+			mxSetFieldByNumber(plhs[2], 0, i, outvar);
+			pr[i] = mxGetPr(outvar);
+		}
+		for( k=0; k<K; k++ )
+		{
+			pr[0][k] = (double)infos[k].it;
+			pr[1][k] = (double)infos[k].it2opt;
+			pr[2][k] = infos[k].res_eq;
+			pr[3][k] = infos[k].res_ineq;
+			pr[4][k] = infos[k].rsnorm;
+			pr[5][k] = infos[k].rcompnorm;
+			pr[6][k] = infos[k].pobj;
+			pr[7][k] = infos[k].mu;
+			pr[8][k] = infos[k].solvetime;
+			pr[9][k] = infos[k].fevalstime;
+		}
+	}
+}
+
+/* solves one problem per column of PARAMS.all_parameters on a thread pool */
+static void solveBatch(solver_int32_default nlhs, mxArray *plhs[], const mxArray *PARAMS, solver_int32_default nthreads, solver_int32_default packed, const solver_int8_default **outputnames, const solver_int8_default **infofields)
+{
+	mwSize K = mxGetN(mxGetField(PARAMS, 0, "all_parameters"));
+	mwSize k, sx0, sxinit, sxfinal, sall;
+	double *x0, *xinit, *xfinal, *all_parameters;
+	FORCESNLPsolver_params *params;
+	FORCESNLPsolver_output *outputs;
+	FORCESNLPsolver_info *infos;
+	solver_int32_default *exitflags;
+
+	x0 = getBatchField(PARAMS, "x0", 1464, K, &sx0);
+	xinit = getBatchField(PARAMS, "xinit", 16, K, &sxinit);
+	xfinal = getBatchField(PARAMS, "xfinal", 11, K, &sxfinal);
+	all_parameters = getBatchField(PARAMS, "all_parameters", 2501, K, &sall);
+
+	/* mxCalloc memory is released by MATLAB also on error */
+	params = (FORCESNLPsolver_params *) mxCalloc(K, sizeof(FORCESNLPsolver_params));
+	outputs = (FORCESNLPsolver_output *) mxCalloc(K, sizeof(FORCESNLPsolver_output));
+	infos = (FORCESNLPsolver_info *) mxCalloc(K, sizeof(FORCESNLPsolver_info));
+	exitflags = (solver_int32_default *) mxCalloc(K, sizeof(solver_int32_default));
+
+	/* copy parameters, single columns are used for all problems */
+	for( k=0; k<K; k++ )
+	{
+		copyMArrayToC(x0 + k*sx0, params[k].x0, 1464);
+		copyMArrayToC(xinit + k*sxinit, params[k].xinit, 16);
+		copyMArrayToC(xfinal + k*sxfinal, params[k].xfinal, 11);
+		copyMArrayToC(all_parameters + k*sall, params[k].all_parameters, 2501);
+	}
+
+	/* call solver */
+	FORCESNLPsolver_solve_batch(params, outputs, infos, exitflags, (solver_int32_default)K, nthreads, pt2function);
+	batchResults(nlhs, plhs, K, packed, outputs, infos, exitflags, outputnames, infofields);
+
+	mxFree(params);
+	mxFree(outputs);
+	mxFree(infos);
+	mxFree(exitflags);
+}
+
+/* solves one problem per column of OVERRIDES, all other parameters are shared from PARAMS */
+static void solveBatchTemplate(solver_int32_default nlhs, mxArray *plhs[], solver_int32_default nrhs, const mxArray *prhs[], const solver_int8_default **outputnames, const solver_int8_default **infofields)
+{
+	const mxArray *PARAMS = prhs[1];
+	const mxArray *OVERRIDES = prhs[5];
+	mwSize K, stride;
+	solver_int32_default len, nblocks, packed, nthreads;
+	mxArray *par;
+	FORCESNLPsolver_params *tmpl;
+	FORCESNLPsolver_float *overrides;
+	FORCESNLPsolver_output *outputs;
+	FORCESNLPsolver_info *infos;
+	solver_int32_default *exitflags;
+
+	if( nrhs < 6 || nrhs > 7 || !mxIsStruct(PARAMS) || !mxIsDouble(OVERRIDES) )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:batch", "use FORCESNLPsolver('batch', PARAMS, FIRST, LEN, STRIDE, OVERRIDES, NTHREADS)");
+	}
+	len = (solver_int32_default)mxGetScalar(prhs[3]);
+	if( len <= 0 || mxGetM(OVERRIDES) % len != 0 )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:batch", "OVERRIDES must have a multiple of LEN rows");
+	}
+	nblocks = (solver_int32_default)(mxGetM(OVERRIDES) / len);
+	K = mxGetN(OVERRIDES);
+	nthreads = nrhs > 6 ? (solver_int32_default)mxGetScalar(prhs[6]) : 0;
+	par = mxGetField(PARAMS, 0, "packed");
+	packed = par != NULL && !mxIsEmpty(par) && mxGetScalar(par) != 0;
+
+	/* one parameter set for all problems */
+	tmpl = (FORCESNLPsolver_params *) mxCalloc(1, sizeof(FORCESNLPsolver_params));
+	copyMArrayToC(getBatchField(PARAMS, "x0", 1464, 1, &stride), tmpl->x0, 1464);
+	copyMArrayToC(getBatchField(PARAMS, "xinit", 16, 1, &stride), tmpl->xinit, 16);
+	copyMArrayToC(getBatchField(PARAMS, "xfinal", 11, 1, &stride), tmpl->xfinal, 11);
+	copyMArrayToC(getBatchField(PARAMS, "all_parameters", 2501, 1, &stride), tmpl->all_parameters, 2501);
+
+	outputs = (FORCESNLPsolver_output *) mxCalloc(K, sizeof(FORCESNLPsolver_output));
+	infos = (FORCESNLPsolver_info *) mxCalloc(K, sizeof(FORCESNLPsolver_info));
+	exitflags = (solver_int32_default *) mxCalloc(K, sizeof(solver_int32_default));
+
+	/* call solver, FIRST is one-based */
+	overrides = getSolverArray(OVERRIDES);
+	if( FORCESNLPsolver_solve_batch_template(tmpl, (solver_int32_default)mxGetScalar(prhs[2]) - 1, len, (solver_int32_default)mxGetScalar(prhs[4]), nblocks,
+	                                         overrides, outputs, infos, exitflags, (solver_int32_default)K, nthreads, pt2function) < 0 )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:batch", "blocks overlap or exceed all_parameters");
+	}
+	batchResults(nlhs, plhs, K, packed, outputs, infos, exitflags, outputnames, infofields);
+
+	freeSolverArray(overrides);
+	mxFree(tmpl);
+	mxFree(outputs);
+	mxFree(infos);
+	mxFree(exitflags);
+}
+
+
+/* solver contexts, kept between calls for warm starts: one for the single
+   solves FORCESNLPsolver(PARAMS) and one for the handle mode, so that neither
+   overwrites the parameters, warm start or options of the other; lastCtx is
+   the one that solved last, for FORCESNLPsolver('sens', ...) */
+static FORCESNLPsolver_context *ctx = NULL;
+static FORCESNLPsolver_context *handleCtx = NULL;
+static FORCESNLPsolver_context *lastCtx = NULL;
+
+/* solver printout goes to the MATLAB command window */
+static void printLog(void *userdata, const char *text, size_t len)
+{
+	(void) userdata;
+	mexPrintf("%.*s", (int)len, text);
+}
+
+/* timings of the context solves, collected after FORCESNLPsolver('profile', 1) */
+static FORCESNLPsolver_profile profile;
+
+/* sweeps of the last solve, recorded after FORCESNLPsolver('trace', 1) */
+static FORCESNLPsolver_trace trace;
+
+/* results of earlier solves, after FORCESNLPsolver('cache', MB) */
+static FORCESNLPsolver_cache *cache = NULL;
+
+/* background solves of FORCESNLPsolver('submit', PARAMS), slot ID-1 until
+   collected by FORCESNLPsolver('wait', ID) */
+#define FORCESNLPsolver_MEX_JOBS (1024)
+static FORCESNLPsolver_pool *pool = NULL;
+static FORCESNLPsolver_context *jobs[FORCESNLPsolver_MEX_JOBS];
+static solver_int32_default jobpacked[FORCESNLPsolver_MEX_JOBS];
+
+/* result arrays of the handle mode, kept between calls and overwritten by each solve */
+static mxArray *handleOutput = NULL;
+static mxArray *handleInfo = NULL;
+
+static void freeContext(void)
+{
+	solver_int32_default i;
+
+	/* submitted solves are finished, the threads stop once none is left */
+	for( i=0; i<FORCESNLPsolver_MEX_JOBS; i++ )
+	{
+		if( jobs[i] != NULL )
+		{
+			FORCESNLPsolver_wait(jobs[i]);
+			mxFree(jobs[i]);
+			jobs[i] = NULL;
+		}
+	}
+	FORCESNLPsolver_pool_destroy(pool);
+	pool = NULL;
+	if( handleOutput != NULL )
+	{
+		mxDestroyArray(handleOutput);
+		mxDestroyArray(handleInfo);
+		handleOutput = NULL;
+		handleInfo = NULL;
+	}
+	FORCESNLPsolver_cache_destroy(cache);
+	cache = NULL;
+	mxFree(ctx);
+	mxFree(handleCtx);
+	ctx = NULL;
+	handleCtx = NULL;
+	lastCtx = NULL;
+}
+
+static FORCESNLPsolver_context *newContext(void)
+{
+	FORCESNLPsolver_context *c = (FORCESNLPsolver_context *) mxCalloc(1, sizeof(FORCESNLPsolver_context));
+
+	mexMakeMemoryPersistent(c);
+	FORCESNLPsolver_init(c, pt2function);
+#if FORCESNLPsolver_SET_PRINTLEVEL > 0
+	FORCESNLPsolver_set_log(c, printLog, NULL);
+#endif
+	return c;
+}
+
+/* create both solver contexts on first call, released when the MEX file is cleared */
+static void makeContext(void)
+{
+	if( ctx == NULL )
+	{
+		ctx = newContext();
+		handleCtx = newContext();
+		mexAtExit(freeContext);
+	}
+}
+
+
+/* parameter vectors in the order of FORCESNLPsolver_params */
+static const solver_int8_default *paramnames[4] = {"x0", "xinit", "xfinal", "all_parameters"};
+static const mwSize paramsizes[4] = {1464, 16, 11, 2501};
+static const mwSize paramoffsets[4] = {0, 1464, 1480, 1491};
+
+/* fields of PARAMS.settings, each with the member of FORCESNLPsolver_settings it sets */
+typedef struct settingsfield
+{
+	const solver_int8_default *name;
+	size_t offset;
+	solver_int32_default integer;
+} settingsfield;
+
+static const settingsfield settingsfields[8] = {
+	{"acc_rdgap", offsetof(FORCESNLPsolver_settings, acc_rdgap), 0},
+	{"acc_reseq", offsetof(FORCESNLPsolver_settings, acc_reseq), 0},
+	{"acc_resineq", offsetof(FORCESNLPsolver_settings, acc_resineq), 0},
+	{"acc_kktcompl", offsetof(FORCESNLPsolver_settings, acc_kktcompl), 0},
+	{"fls_scale", offsetof(FORCESNLPsolver_settings, fls_scale), 0},
+	{"maxit", offsetof(FORCESNLPsolver_settings, maxit), 1},
+	{"max_soc_it", offsetof(FORCESNLPsolver_settings, max_soc_it), 1},
+	{"printlevel", offsetof(FORCESNLPsolver_settings, printlevel), 1}};
+
+/* settings of target from a structure with some of the fields settingsfields, defaults for the others */
+static void setSettings(FORCESNLPsolver_context *target, const mxArray *value)
+{
+	FORCESNLPsolver_settings settings;
+	mxArray *field;
+	char *member;
+	solver_int32_default i;
+
+	if( !mxIsStruct(value) )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:settings", "PARAMS.settings must be a structure");
+	}
+	FORCESNLPsolver_default_settings(&settings);
+	for( i=0; i<8; i++ )
+	{
+		field = mxGetField(value, 0, settingsfields[i].name);
+		if( field == NULL || mxIsEmpty(field) )
+		{
+			continue;
+		}
+		member = (char *) &settings + settingsfields[i].offset;
+		if( !settingsfields[i].integer )
+		{
+			*(FORCESNLPsolver_float *) member = (FORCESNLPsolver_float) mxGetScalar(field);
+		}
+		else
+		{
+			if( mxGetScalar(field) < 0 || mxGetScalar(field) != (double)(solver_int32_default)mxGetScalar(field) )
+			{
+				mexErrMsgIdAndTxt("FORCESNLPsolver:settings", "PARAMS.settings.%s must be a nonnegative integer", settingsfields[i].name);
+			}
+			*(solver_int32_default *) member = (solver_int32_default) mxGetScalar(field);
+		}
+	}
+	FORCESNLPsolver_set_settings(target, &settings);
+}
+
+/* copies value to the parameter of target called name; warmstart, timelimit and
+   settings set the corresponding solve options */
+static void setParam(FORCESNLPsolver_context *target, const char *name, const mxArray *value)
+{
+	solver_int32_default i;
+
+	if( strcmp(name, "warmstart") == 0 )
+	{
+		target->warmstart = !mxIsEmpty(value) ? (solver_int32_default)mxGetScalar(value) : FORCESNLPsolver_WARMSTART_OFF;
+		return;
+	}
+	if( strcmp(name, "timelimit") == 0 )
+	{
+		FORCESNLPsolver_set_time_limit(target, !mxIsEmpty(value) ? (FORCESNLPsolver_float)mxGetScalar(value) : 0);
+		return;
+	}
+	if( strcmp(name, "settings") == 0 )
+	{
+		setSettings(target, value);
+		return;
+	}
+	for( i=0; i<4; i++ )
+	{
+		if( strcmp(name, paramnames[i]) == 0 )
+		{
+			if( !mxIsDouble(value) || mxGetNumberOfElements(value) != paramsizes[i] )
+			{
+				mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "PARAMS.%s must be a double with %d elements", name, (int)paramsizes[i]);
+			}
+			/* the parameter vectors of FORCESNLPsolver_params are contiguous */
+			copyMArrayToC(mxGetPr(value), (FORCESNLPsolver_float *) &target->params + paramoffsets[i], (solver_int32_default)paramsizes[i]);
+			return;
+		}
+	}
+	mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "unknown parameter %s", name);
+}
+
+/* solve options of PARAMS (warmstart, timelimit, settings), reset to the defaults if not given */
+static void setOptions(FORCESNLPsolver_context *target, const mxArray *PARAMS)
+{
+	mxArray *par;
+
+	target->warmstart = FORCESNLPsolver_WARMSTART_OFF;
+	FORCESNLPsolver_set_time_limit(target, 0);
+	FORCESNLPsolver_set_settings(target, NULL);
+	par = mxGetField(PARAMS, 0, "warmstart");
+	if( par != NULL )
+	{
+		setParam(target, "warmstart", par);
+	}
+	par = mxGetField(PARAMS, 0, "timelimit");
+	if( par != NULL )
+	{
+		setParam(target, "timelimit", par);
+	}
+	par = mxGetField(PARAMS, 0, "settings");
+	if( par != NULL )
+	{
+		setParam(target, "settings", par);
+	}
+}
+
+/* returns profile as a structure, evals and evaltime as [61 x 1] */
+static mxArray *profileStruct(void)
+{
+	const solver_int8_default *profilefields[7] = {"nsolves", "iterations", "solvetime", "fevalstime", "coretime", "evals", "evaltime"};
+	mxArray *prof = mxCreateStructMatrix(1, 1, 7, profilefields);
+	mxArray *evals = mxCreateDoubleMatrix(61, 1, mxREAL);
+	mxArray *evaltime = mxCreateDoubleMatrix(61, 1, mxREAL);
+	solver_int32_default i;
+
+	mxSetFieldByNumber(prof, 0, 0, mxCreateDoubleScalar((double)profile.nsolves));
+	mxSetFieldByNumber(prof, 0, 1, mxCreateDoubleScalar((double)profile.iterations));
+	mxSetFieldByNumber(prof, 0, 2, mxCreateDoubleScalar(profile.solvetime));
+	mxSetFieldByNumber(prof, 0, 3, mxCreateDoubleScalar(profile.fevalstime));
+	mxSetFieldByNumber(prof, 0, 4, mxCreateDoubleScalar(profile.coretime));
+	for( i=0; i<61; i++ )
+	{
+		mxGetPr(evals)[i] = (double)profile.evals[i];
+		mxGetPr(evaltime)[i] = profile.evaltime[i];
+	}
+	mxSetFieldByNumber(prof, 0, 5, evals);
+	mxSetFieldByNumber(prof, 0, 6, evaltime);
+	return prof;
+}
+
+/* returns the kept sweeps of trace, oldest first, as rows [sweep, time, pobj] */
+static mxArray *traceMatrix(void)
+{
+	solver_int32_default i, k, first, rows;
+	mxArray *mat;
+	double *pr;
+
+	rows = trace.count < FORCESNLPsolver_TRACE_SIZE ? trace.count : FORCESNLPsolver_TRACE_SIZE;
+	first = trace.count - rows;
+	mat = mxCreateDoubleMatrix(rows, 3, mxREAL);
+	pr = mxGetPr(mat);
+	for( i=0; i<rows; i++ )
+	{
+		k = (first + i) % FORCESNLPsolver_TRACE_SIZE;
+		pr[i] = (double)trace.entries[k].sweep;
+		pr[rows + i] = trace.entries[k].time;
+		pr[2*rows + i] = trace.entries[k].pobj;
+	}
+	return mat;
+}
+
+/* returns the counters of cache as a structure */
+static mxArray *cacheStruct(void)
+{
+	const solver_int8_default *cachefields[6] = {"hits", "misses", "seeded", "evictions", "entries", "capacity"};
+	mxArray *st = mxCreateStructMatrix(1, 1, 6, cachefields);
+	FORCESNLPsolver_cache_stats stats;
+
+	memset(&stats, 0, sizeof(stats));
+	if( cache != NULL )
+	{
+		FORCESNLPsolver_cache_get_stats(cache, &stats);
+	}
+	mxSetFieldByNumber(st, 0, 0, mxCreateDoubleScalar((double)stats.hits));
+	mxSetFieldByNumber(st, 0, 1, mxCreateDoubleScalar((double)stats.misses));
+	mxSetFieldByNumber(st, 0, 2, mxCreateDoubleScalar((double)stats.seeded));
+	mxSetFieldByNumber(st, 0, 3, mxCreateDoubleScalar((double)stats.evictions));
+	mxSetFieldByNumber(st, 0, 4, mxCreateDoubleScalar((double)stats.entries));
+	mxSetFieldByNumber(st, 0, 5, mxCreateDoubleScalar((double)stats.capacity));
+	return st;
+}
+
+/* histogram of the metrics as rows [upper bound, count], Inf as the last bound */
+static mxArray *histogramMatrix(const double *bounds, solver_int32_default nbounds, const solver_int64_default *counts)
+{
+	mxArray *h = mxCreateDoubleMatrix(nbounds + 1, 2, mxREAL);
+	solver_int32_default i;
+
+	for( i=0; i<=nbounds; i++ )
+	{
+		mxGetPr(h)[i] = i < nbounds ? bounds[i] : mxGetInf();
+		mxGetPr(h)[nbounds + 1 + i] = (double)counts[i];
+	}
+	return h;
+}
+
+/* process-wide counters of all solves of the library */
+static mxArray *metricsStruct(void)
+{
+	const solver_int8_default *metricsfields[10] = {"solves", "iterations", "solvetime", "fevalstime", "iterations_sum", "solvetime_sum", "fevalstime_sum", "warmstarts", "cache_hits", "cache_misses"};
+	const solver_int8_default *exitflagfields[FORCESNLPsolver_METRICS_NEXITFLAGS] = {"OPTIMAL", "MAXITREACHED", "FACTORIZATION_ERROR", "BADFUNCEVAL", "NOPROGRESS", "TIMELIMIT_REACHED", "OTHER"};
+	const double iterations[FORCESNLPsolver_METRICS_NITERATIONS] = FORCESNLPsolver_METRICS_ITERATIONS;
+	const double seconds[FORCESNLPsolver_METRICS_NSECONDS] = FORCESNLPsolver_METRICS_SECONDS;
+	mxArray *st = mxCreateStructMatrix(1, 1, 10, metricsfields);
+	mxArray *solves = mxCreateStructMatrix(1, 1, FORCESNLPsolver_METRICS_NEXITFLAGS, exitflagfields);
+	FORCESNLPsolver_metrics m;
+	solver_int32_default i;
+
+	FORCESNLPsolver_get_metrics(&m);
+	for( i=0; i<FORCESNLPsolver_METRICS_NEXITFLAGS; i++ )
+	{
+		mxSetFieldByNumber(solves, 0, i, mxCreateDoubleScalar((double)m.solves[i]));
+	}
+	mxSetFieldByNumber(st, 0, 0, solves);
+	mxSetFieldByNumber(st, 0, 1, histogramMatrix(iterations, FORCESNLPsolver_METRICS_NITERATIONS, m.iterations));
+	mxSetFieldByNumber(st, 0, 2, histogramMatrix(seconds, FORCESNLPsolver_METRICS_NSECONDS, m.solvetime));
+	mxSetFieldByNumber(st, 0, 3, histogramMatrix(seconds, FORCESNLPsolver_METRICS_NSECONDS, m.fevalstime));
+	mxSetFieldByNumber(st, 0, 4, mxCreateDoubleScalar((double)m.iterations_sum));
+	mxSetFieldByNumber(st, 0, 5, mxCreateDoubleScalar(m.solvetime_sum));
+	mxSetFieldByNumber(st, 0, 6, mxCreateDoubleScalar(m.fevalstime_sum));
+	mxSetFieldByNumber(st, 0, 7, mxCreateDoubleScalar((double)m.warmstarts));
+	mxSetFieldByNumber(st, 0, 8, mxCreateDoubleScalar((double)m.cache_hits));
+	mxSetFieldByNumber(st, 0, 9, mxCreateDoubleScalar((double)m.cache_misses));
+	return st;
+}
+
+/* handle mode: FORCESNLPsolver('init', PARAMS) and FORCESNLPsolver('solve', ...) */
+static void handleCommand(solver_int32_default nlhs, mxArray *plhs[], solver_int32_default nrhs, const mxArray *prhs[], const solver_int8_default **outputnames, const solver_int8_default **infofields)
+{
+	char cmd[8], name[32];
+	solver_int32_default i, len, packed, slot, status;
+	mxArray *par;
+	double *pr;
+	FORCESNLPsolver_float *values, *dx;
+	FORCESNLPsolver_context *job;
+	char *text;
+
+	if( mxGetString(prhs[0], cmd, sizeof(cmd)) != 0 )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "unknown command, use 'init', 'update', 'solve', 'batch', 'profile', 'trace', 'cache', 'metrics', 'sens', 'submit', 'poll' or 'wait'");
+	}
+
+	if( strcmp(cmd, "batch") == 0 )
+	{
+		solveBatchTemplate(nlhs, plhs, nrhs, prhs, outputnames, infofields);
+		return;
+	}
+
+	if( strcmp(cmd, "init") == 0 )
+	{
+		if( nrhs != 2 || !mxIsStruct(prhs[1]) )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "use FORCESNLPsolver('init', PARAMS) with PARAMS a structure");
+		}
+		makeContext();
+		for( i=0; i<4; i++ )
+		{
+			par = mxGetField(prhs[1], 0, paramnames[i]);
+			if( par == NULL )
+			{
+				mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "PARAMS.%s not found", paramnames[i]);
+			}
+			setParam(handleCtx, paramnames[i], par);
+		}
+		setOptions(handleCtx, prhs[1]);
+		FORCESNLPsolver_reset_warmstart(handleCtx);
+
+		/* result arrays are created once with the layout chosen here */
+		par = mxGetField(prhs[1], 0, "packed");
+		packed = par != NULL && !mxIsEmpty(par) && mxGetScalar(par) != 0;
+		if( handleOutput != NULL )
+		{
+			mxDestroyArray(handleOutput);
+			mxDestroyArray(handleInfo);
+		}
+		if( packed )
+		{
+			handleOutput = mxCreateDoubleMatrix(24, 61, mxREAL);
+		}
+		else
+		{
+			handleOutput = mxCreateStructMatrix(1, 1, 61, outputnames);
+			for( i=0; i<61; i++ )
+			{
+				mxSetFieldByNumber(handleOutput, 0, i, mxCreateDoubleMatrix(24, 1, mxREAL));
+			}
+		}
+		handleInfo = mxCreateStructMatrix(1, 1, 10, infofields);
+		for( i=0; i<10; i++ )
+		{
+			mxSetFieldByNumber(handleInfo, 0, i, mxCreateDoubleMatrix(1, 1, mxREAL));
+		}
+		mexMakeArrayPersistent(handleOutput);
+		mexMakeArrayPersistent(handleInfo);
+		return;
+	}
+
+	/* FORCESNLPsolver('profile', ON) resets and starts (ON nonzero) or stops profiling,
+	   PROFILE = FORCESNLPsolver('profile') returns the timings collected so far */
+	if( strcmp(cmd, "profile") == 0 )
+	{
+		makeContext();
+		if( nrhs > 1 )
+		{
+			FORCESNLPsolver_reset_profile(&profile);
+			FORCESNLPsolver_set_profile(ctx, mxGetScalar(prhs[1]) != 0 ? &profile : NULL);
+			FORCESNLPsolver_set_profile(handleCtx, mxGetScalar(prhs[1]) != 0 ? &profile : NULL);
+		}
+		if( nrhs == 1 || nlhs > 0 )
+		{
+			plhs[0] = profileStruct();
+		}
+		return;
+	}
+
+	/* FORCESNLPsolver('trace', ON) starts (ON nonzero) or stops recording the sweeps,
+	   TRACE = FORCESNLPsolver('trace') returns those of the last solve */
+	if( strcmp(cmd, "trace") == 0 )
+	{
+		makeContext();
+		if( nrhs > 1 )
+		{
+			FORCESNLPsolver_set_trace(ctx, mxGetScalar(prhs[1]) != 0 ? &trace : NULL);
+			FORCESNLPsolver_set_trace(handleCtx, mxGetScalar(prhs[1]) != 0 ? &trace : NULL);
+		}
+		if( nrhs == 1 || nlhs > 0 )
+		{
+			plhs[0] = traceMatrix();
+		}
+		return;
+	}
+
+	/* FORCESNLPsolver('cache', MB) keeps the results of the following solves in a
+	   cache of MB megabytes (0: none), STATS = FORCESNLPsolver('cache') returns its counters */
+	if( strcmp(cmd, "cache") == 0 )
+	{
+		makeContext();
+		if( nrhs > 1 )
+		{
+			FORCESNLPsolver_cache_destroy(cache);
+			cache = NULL;
+			if( mxGetScalar(prhs[1]) > 0 )
+			{
+				cache = FORCESNLPsolver_cache_create((size_t)(mxGetScalar(prhs[1]) * 1024 * 1024));
+				if( cache == NULL )
+				{
+					FORCESNLPsolver_set_cache(ctx, NULL);
+					FORCESNLPsolver_set_cache(handleCtx, NULL);
+					mexErrMsgIdAndTxt("FORCESNLPsolver:cache", "could not allocate a cache of %g MB", mxGetScalar(prhs[1]));
+				}
+			}
+			FORCESNLPsolver_set_cache(ctx, cache);
+			FORCESNLPsolver_set_cache(handleCtx, cache);
+		}
+		if( nrhs == 1 || nlhs > 0 )
+		{
+			plhs[0] = cacheStruct();
+		}
+		return;
+	}
+
+	/* METRICS = FORCESNLPsolver('metrics') returns the process-wide counters,
+	   TEXT = FORCESNLPsolver('metrics', 'text') the same in the Prometheus text
+	   format, FORCESNLPsolver('metrics', 'reset') zeros them */
+	if( strcmp(cmd, "metrics") == 0 )
+	{
+		if( nrhs > 2 || (nrhs == 2 && (mxGetString(prhs[1], name, sizeof(name)) != 0 || (strcmp(name, "text") != 0 && strcmp(name, "reset") != 0))) )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:metrics", "use FORCESNLPsolver('metrics'), FORCESNLPsolver('metrics', 'text') or FORCESNLPsolver('metrics', 'reset')");
+		}
+		if( nrhs == 1 )
+		{
+			plhs[0] = metricsStruct();
+		}
+		else if( strcmp(name, "text") == 0 )
+		{
+			/* the counters may grow between the two calls, leave some room */
+			len = (solver_int32_default)FORCESNLPsolver_metrics_export(NULL, 0) + 256;
+			text = (char *) mxCalloc((mwSize)len, sizeof(char));
+			FORCESNLPsolver_metrics_export(text, (size_t)len);
+			plhs[0] = mxCreateString(text);
+			mxFree(text);
+		}
+		else
+		{
+			FORCESNLPsolver_reset_metrics();
+		}
+		return;
+	}
+
+	/* DX = FORCESNLPsolver('sens', DIRECTIONS, STEP, NTHREADS, ONESIDED) differentiates
+	   the solution of the last solve along the columns of DIRECTIONS */
+	if( strcmp(cmd, "sens") == 0 )
+	{
+		if( nrhs < 2 || nrhs > 5 || !mxIsDouble(prhs[1]) || mxGetM(prhs[1]) != 2501 )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:sens", "use FORCESNLPsolver('sens', DIRECTIONS, STEP, NTHREADS, ONESIDED) with DIRECTIONS of size [2501 x K]");
+		}
+		if( lastCtx == NULL || lastCtx->exitflag != FORCESNLPsolver_OPTIMAL )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:sens", "the last solve did not end with EXITFLAG 1");
+		}
+		len = (solver_int32_default)mxGetN(prhs[1]);
+		values = getSolverArray(prhs[1]);
+		dx = (FORCESNLPsolver_float *) mxCalloc((mwSize)len * 1464 + 1, sizeof(FORCESNLPsolver_float));
+		status = FORCESNLPsolver_sensitivity(lastCtx, values, len, nrhs > 2 ? (FORCESNLPsolver_float)mxGetScalar(prhs[2]) : 0,
+		                                     nrhs > 4 && mxGetScalar(prhs[4]) != 0,
+		                                     dx, nrhs > 3 ? (solver_int32_default)mxGetScalar(prhs[3]) : 0);
+		if( status == FORCESNLPsolver_SENSITIVITY_NOMINAL_FAILED )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:sens", "the last solution could not be refined to the tolerances of STEP, use a larger STEP");
+		}
+		if( status == FORCESNLPsolver_SENSITIVITY_NO_MEMORY )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:sens", "out of memory");
+		}
+		if( status < 0 )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:sens", "the last solve did not end with EXITFLAG 1");
+		}
+		plhs[0] = mxCreateDoubleMatrix(1464, len, mxREAL);
+		copyCArrayToM(dx, mxGetPr(plhs[0]), len * 1464);
+		freeSolverArray(values);
+		mxFree(dx);
+		return;
+	}
 
+	/* ID = FORCESNLPsolver('submit', PARAMS) starts solving PARAMS on the solver
+	   threads and returns at once */
+	if( strcmp(cmd, "submit") == 0 )
+	{
+		if( nrhs != 2 || !mxIsStruct(prhs[1]) )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:submit", "use ID = FORCESNLPsolver('submit', PARAMS) with PARAMS a structure");
+		}
+		makeContext();
+		for( slot=0; slot<FORCESNLPsolver_MEX_JOBS && jobs[slot] != NULL; slot++ )
+		{
+		}
+		if( slot == FORCESNLPsolver_MEX_JOBS )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:submit", "%d solves are outstanding, collect some with FORCESNLPsolver('wait', ID) first", FORCESNLPsolver_MEX_JOBS);
+		}
+		if( pool == NULL && (pool = FORCESNLPsolver_pool_create(0)) == NULL )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:submit", "could not start the solver threads");
+		}
+
+		/* freed by MATLAB on an error below, kept once submitted; no printout
+		   from the solver threads */
+		job = (FORCESNLPsolver_context *) mxCalloc(1, sizeof(FORCESNLPsolver_context));
+		FORCESNLPsolver_init(job, pt2function);
+		for( i=0; i<4; i++ )
+		{
+			par = mxGetField(prhs[1], 0, paramnames[i]);
+			if( par == NULL )
+			{
+				mexErrMsgIdAndTxt("FORCESNLPsolver:submit", "PARAMS.%s not found", paramnames[i]);
+			}
+			setParam(job, paramnames[i], par);
+		}
+		setOptions(job, prhs[1]);
+		par = mxGetField(prhs[1], 0, "packed");
+		jobpacked[slot] = par != NULL && !mxIsEmpty(par) && mxGetScalar(par) != 0;
+
+		mexMakeMemoryPersistent(job);
+		jobs[slot] = job;
+		FORCESNLPsolver_submit(pool, job, NULL, NULL);
+		plhs[0] = mxCreateDoubleScalar((double)(slot + 1));
+		return;
+	}
+
+	/* FORCESNLPsolver('poll', ID) is true once the solve ID has finished,
+	   [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver('wait', ID) waits for it and
+	   returns its results like a single solve; ID is free again afterwards */
+	if( strcmp(cmd, "poll") == 0 || strcmp(cmd, "wait") == 0 )
+	{
+		slot = nrhs == 2 && mxIsNumeric(prhs[1]) ? (solver_int32_default)mxGetScalar(prhs[1]) - 1 : -1;
+		if( slot < 0 || slot >= FORCESNLPsolver_MEX_JOBS || jobs[slot] == NULL )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:submit", "use FORCESNLPsolver('%s', ID) with ID of a solve submitted and not yet collected", cmd);
+		}
+		job = jobs[slot];
+		if( strcmp(cmd, "poll") == 0 )
+		{
+			plhs[0] = mxCreateLogicalScalar(FORCESNLPsolver_poll(job) != 0);
+			return;
+		}
+		FORCESNLPsolver_wait(job);
+		batchResults(nlhs, plhs, 1, jobpacked[slot], &job->output, &job->info, &job->exitflag, outputnames, infofields);
+		mxFree(job);
+		jobs[slot] = NULL;
+		return;
+	}
 
-/* Some memory for mex-function */
-FORCESNLPsolver_params params;
-FORCESNLPsolver_output output;
-FORCESNLPsolver_info info;
+	if( strcmp(cmd, "update") != 0 && strcmp(cmd, "solve") != 0 )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "unknown command %s, use 'init', 'update', 'solve', 'batch', 'profile', 'trace', 'cache', 'metrics', 'sens', 'submit', 'poll' or 'wait'", cmd);
+	}
+	if( handleOutput == NULL )
+	{
+		mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "call FORCESNLPsolver('init', PARAMS) first");
+	}
+
+	/* FORCESNLPsolver('update', FIRST, LEN, STRIDE, VALUES) rewrites part of all_parameters */
+	if( strcmp(cmd, "update") == 0 )
+	{
+		if( nrhs != 5 || !mxIsDouble(prhs[4]) )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "use FORCESNLPsolver('update', FIRST, LEN, STRIDE, VALUES)");
+		}
+		len = (solver_int32_default)mxGetScalar(prhs[2]);
+		if( len <= 0 || mxGetNumberOfElements(prhs[4]) % len != 0 )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "VALUES must hold a multiple of LEN elements");
+		}
+		values = getSolverArray(prhs[4]);
+		if( FORCESNLPsolver_set_param_slice(handleCtx, (solver_int32_default)mxGetScalar(prhs[1]) - 1, len, (solver_int32_default)mxGetScalar(prhs[3]),
+		                                    (solver_int32_default)(mxGetNumberOfElements(prhs[4]) / len), values) != 0 )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "blocks overlap or exceed all_parameters");
+		}
+		freeSolverArray(values);
+		return;
+	}
+
+	/* update only the parameters given, as a structure or as name/value pairs */
+	if( nrhs == 2 && mxIsStruct(prhs[1]) )
+	{
+		for( i=0; i<mxGetNumberOfFields(prhs[1]); i++ )
+		{
+			setParam(handleCtx, mxGetFieldNameByNumber(prhs[1], i), mxGetFieldByNumber(prhs[1], 0, i));
+		}
+	}
+	else
+	{
+		if( nrhs % 2 == 0 )
+		{
+			mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "parameter updates must be given as name/value pairs");
+		}
+		for( i=1; i<nrhs; i+=2 )
+		{
+			if( !mxIsChar(prhs[i]) )
+			{
+				mexErrMsgIdAndTxt("FORCESNLPsolver:handle", "parameter name expected");
+			}
+			mxGetString(prhs[i], name, sizeof(name));
+			setParam(handleCtx, name, prhs[i+1]);
+		}
+	}
+
+	/* call solver, printout is forwarded by printLog */
+	FORCESNLPsolver_solve_ctx(handleCtx);
+	lastCtx = handleCtx;
+
+	/* overwrite the kept result arrays, then hand out copies */
+	if( !mxIsStruct(handleOutput) )
+	{
+		copyCArrayToM( (FORCESNLPsolver_float *) &handleCtx->output, mxGetPr(handleOutput), 1464);
+	}
+	else
+	{
+		for( i=0; i<61; i++ )
+		{
+			copyCArrayToM( (FORCESNLPsolver_float *) &handleCtx->output + 24*i, mxGetPr(mxGetFieldByNumber(handleOutput, 0, i)), 24);
+		}
+	}
+	plhs[0] = mxDuplicateArray(handleOutput);
+	if( nlhs > 1 )
+	{
+		plhs[1] = mxCreateDoubleScalar((double)handleCtx->exitflag);
+	}
+	if( nlhs > 2 )
+	{
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 0)); *pr = (double)handleCtx->info.it;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 1)); *pr = (double)handleCtx->info.it2opt;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 2)); *pr = handleCtx->info.res_eq;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 3)); *pr = handleCtx->info.res_ineq;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 4)); *pr = handleCtx->info.rsnorm;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 5)); *pr = handleCtx->info.rcompnorm;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 6)); *pr = handleCtx->info.pobj;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 7)); *pr = handleCtx->info.mu;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 8)); *pr = handleCtx->info.solvetime;
+		pr = mxGetPr(mxGetFieldByNumber(handleInfo, 0, 9)); *pr = handleCtx->info.fevalstime;
+		plhs[2] = mxDuplicateArray(handleInfo);
+	}
+}
 
 /* THE mex-function */
 void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_default nrhs, const mxArray *prhs[] )  
 {
-	/* file pointer for printing */
-	FILE *fp = NULL;
-
 	/* define variables */	
 	mxArray *par;
 	mxArray *outvar;
@@ -68,14 +950,22 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
 	double *pvalue;
 	solver_int32_default i;
 	solver_int32_default exitflag;
+	solver_int32_default packed;
 	const solver_int8_default *fname;
 	const solver_int8_default *outputnames[61] = {"x01","x02","x03","x04","x05","x06","x07","x08","x09","x10","x11","x12","x13","x14","x15","x16","x17","x18","x19","x20","x21","x22","x23","x24","x25","x26","x27","x28","x29","x30","x31","x32","x33","x34","x35","x36","x37","x38","x39","x40","x41","x42","x43","x44","x45","x46","x47","x48","x49","x50","x51","x52","x53","x54","x55","x56","x57","x58","x59","x60","x61"};
 	const solver_int8_default *infofields[10] = { "it", "it2opt", "res_eq", "res_ineq",  "rsnorm",  "rcompnorm",  "pobj",  "mu",  "solvetime",  "fevalstime"};
 	
+	/* FORCESNLPsolver('init', PARAMS) and FORCESNLPsolver('solve', ...) */
+	if( nrhs >= 1 && mxIsChar(prhs[0]) )
+	{
+		handleCommand(nlhs, plhs, nrhs, prhs, outputnames, infofields);
+		return;
+	}
+
 	/* Check for proper number of arguments */
-    if (nrhs != 1) 
+    if (nrhs < 1 || nrhs > 2) 
 	{
-        mexErrMsgTxt("This function requires exactly 1 input: PARAMS struct.\nType 'help FORCESNLPsolver_mex' for details.");
+        mexErrMsgTxt("This function requires 1 or 2 inputs: PARAMS struct and optional number of threads.\nType 'help FORCESNLPsolver_mex' for details.");
     }    
 	if (nlhs > 3) 
 	{
@@ -88,6 +978,27 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
 		mexErrMsgTxt("PARAMS must be a structure.");
 	}
 
+	/* optional packed output: one 24 x 61 matrix instead of the fields x01 ... x61 */
+	par = mxGetField(PARAMS, 0, "packed");
+	packed = par != NULL && !mxIsEmpty(par) && mxGetScalar(par) != 0;
+
+	/* several columns in PARAMS.all_parameters are solved as one batch */
+	par = mxGetField(PARAMS, 0, "all_parameters");
+	if( par != NULL && mxGetN(par) > 1 )
+	{
+		solveBatch(nlhs, plhs, PARAMS, nrhs > 1 ? (solver_int32_default)mxGetScalar(prhs[1]) : 0, packed, outputnames, infofields);
+		return;
+	}
+
+	makeContext();
+
+	/* threads inside the solve, used by an OpenMP build only */
+	FORCESNLPsolver_set_num_threads(ctx, nrhs > 1 ? (solver_int32_default)mxGetScalar(prhs[1]) : 0);
+
+	/* optional warm start mode (0 - off, 1 - last optimal solution, 2 - shifted by one stage),
+	   time limit and settings */
+	setOptions(ctx, PARAMS);
+
 	/* copy parameters into the right location */
 	par = mxGetField(PARAMS, 0, "x0");
 #ifdef MEXARGMUENTCHECKS
@@ -104,7 +1015,7 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
     mexErrMsgTxt("PARAMS.x0 must be of size [1464 x 1]");
     }
 #endif	 
-    copyMArrayToC(mxGetPr(par), params.x0, 1464);
+    copyMArrayToC(mxGetPr(par), ctx->params.x0, 1464);
 
 	par = mxGetField(PARAMS, 0, "xinit");
 #ifdef MEXARGMUENTCHECKS
@@ -121,7 +1032,7 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
     mexErrMsgTxt("PARAMS.xinit must be of size [16 x 1]");
     }
 #endif	 
-    copyMArrayToC(mxGetPr(par), params.xinit, 16);
+    copyMArrayToC(mxGetPr(par), ctx->params.xinit, 16);
 
 	par = mxGetField(PARAMS, 0, "xfinal");
 #ifdef MEXARGMUENTCHECKS
@@ -138,7 +1049,7 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
     mexErrMsgTxt("PARAMS.xfinal must be of size [11 x 1]");
     }
 #endif	 
-    copyMArrayToC(mxGetPr(par), params.xfinal, 11);
+    copyMArrayToC(mxGetPr(par), ctx->params.xfinal, 11);
 
 	par = mxGetField(PARAMS, 0, "all_parameters");
 #ifdef MEXARGMUENTCHECKS
@@ -155,280 +1066,29 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
     mexErrMsgTxt("PARAMS.all_parameters must be of size [2501 x 1]");
     }
 #endif	 
-    copyMArrayToC(mxGetPr(par), params.all_parameters, 2501);
+    copyMArrayToC(mxGetPr(par), ctx->params.all_parameters, 2501);
 
-	#if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Prepare file for printfs */
-		/*fp = freopen("stdout_temp","w+",stdout);*/
-        fp = fopen("stdout_temp","w+");
-		if( fp == NULL ) 
-		{
-			mexErrMsgTxt("freopen of stdout did not work.");
-		}
-		rewind(fp);
-	#endif
-
-	/* call solver */
-	exitflag = FORCESNLPsolver_solve(&params, &output, &info, fp, pt2function);
+	/* call solver, printout is forwarded by printLog */
+	exitflag = FORCESNLPsolver_solve_ctx(ctx);
+	lastCtx = ctx;
 
-	/* close stdout */
-	/* fclose(fp); */
-	
-	#if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Read contents of printfs printed to file */
-		rewind(fp);
-		while( (i = fgetc(fp)) != EOF ) 
+	/* copy output to matlab arrays, packed as one 24 x 61 matrix if requested */
+	if( packed )
+	{
+		plhs[0] = mxCreateDoubleMatrix(24, 61, mxREAL);
+		/* the 61 stage vectors of FORCESNLPsolver_output are contiguous, like x0 */
+		copyCArrayToM( (FORCESNLPsolver_float *) &ctx->output, mxGetPr(plhs[0]), 1464);
+	}
+	else
+	{
+		plhs[0] = mxCreateStructMatrix(1, 1, 61, outputnames);
+		for( i=0; i<61; i++ )
 		{
-			mexPrintf("%c",i);
+			outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
+			copyCArrayToM( (FORCESNLPsolver_float *) &ctx->output + 24*i, mxGetPr(outvar), 24);
+			mxSetFieldByNumber(plhs[0], 0, i, outvar);
 		}
-		fclose(fp);
-	#endif
-
-	/* copy output to matlab arrays */
-	plhs[0] = mxCreateStructMatrix(1, 1, 61, outputnames);
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x01, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x01", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x02, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x02", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x03, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x03", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x04, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x04", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x05, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x05", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x06, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x06", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x07, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x07", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x08, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x08", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x09, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x09", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x10, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x10", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x11, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x11", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x12, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x12", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x13, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x13", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x14, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x14", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x15, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x15", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x16, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x16", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x17, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x17", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x18, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x18", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x19, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x19", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x20, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x20", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x21, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x21", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x22, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x22", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x23, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x23", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x24, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x24", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x25, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x25", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x26, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x26", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x27, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x27", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x28, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x28", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x29, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x29", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x30, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x30", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x31, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x31", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x32, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x32", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x33, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x33", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x34, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x34", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x35, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x35", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x36, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x36", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x37, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x37", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x38, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x38", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x39, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x39", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x40, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x40", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x41, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x41", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x42, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x42", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x43, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x43", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x44, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x44", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x45, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x45", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x46, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x46", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x47, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x47", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x48, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x48", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x49, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x49", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x50, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x50", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x51, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x51", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x52, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x52", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x53, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x53", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x54, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x54", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x55, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x55", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x56, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x56", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x57, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x57", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x58, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x58", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x59, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x59", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x60, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x60", outvar);
-
-	outvar = mxCreateDoubleMatrix(24, 1, mxREAL);
-	copyCArrayToM( output.x61, mxGetPr(outvar), 24);
-	mxSetField(plhs[0], 0, "x61", outvar);	
+	}
 
 	/* copy exitflag */
 	if( nlhs > 1 )
@@ -445,52 +1105,52 @@ void mexFunction( solver_int32_default nlhs, mxArray *plhs[], solver_int32_defau
 		
 		/* iterations */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = (double)info.it;
+		*mxGetPr(outvar) = (double)ctx->info.it;
 		mxSetField(plhs[2], 0, "it", outvar);
 
 		/* iterations to optimality (branch and bound) */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = (double)info.it2opt;
+		*mxGetPr(outvar) = (double)ctx->info.it2opt;
 		mxSetField(plhs[2], 0, "it2opt", outvar);
 		
 		/* res_eq */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.res_eq;
+		*mxGetPr(outvar) = ctx->info.res_eq;
 		mxSetField(plhs[2], 0, "res_eq", outvar);
 
 		/* res_ineq */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.res_ineq;
+		*mxGetPr(outvar) = ctx->info.res_ineq;
 		mxSetField(plhs[2], 0, "res_ineq", outvar);
 
 		/* rsnorm */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.rsnorm;
+		*mxGetPr(outvar) = ctx->info.rsnorm;
 		mxSetField(plhs[2], 0, "rsnorm", outvar);
 
 		/* rcompnorm */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.rcompnorm;
+		*mxGetPr(outvar) = ctx->info.rcompnorm;
 		mxSetField(plhs[2], 0, "rcompnorm", outvar);
 		
 		/* pobj */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.pobj;
+		*mxGetPr(outvar) = ctx->info.pobj;
 		mxSetField(plhs[2], 0, "pobj", outvar);
 
 		/* mu */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.mu;
+		*mxGetPr(outvar) = ctx->info.mu;
 		mxSetField(plhs[2], 0, "mu", outvar);
 
 		/* solver time */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.solvetime;
+		*mxGetPr(outvar) = ctx->info.solvetime;
 		mxSetField(plhs[2], 0, "solvetime", outvar);
 
 		/* solver time */
 		outvar = mxCreateDoubleMatrix(1, 1, mxREAL);
-		*mxGetPr(outvar) = info.fevalstime;
+		*mxGetPr(outvar) = ctx->info.fevalstime;
 		mxSetField(plhs[2], 0, "fevalstime", outvar);
 	}
 }
\ No newline at end of file
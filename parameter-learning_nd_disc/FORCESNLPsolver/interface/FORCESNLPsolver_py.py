@@ -103,6 +103,7 @@ a Python wrapper for a fast solver generated by FORCES Pro v1.6.121
       -6 - NaN or INF occured during evaluation of functions and derivatives. Please check your initial guess.
       -7 - Method could not progress. Problem may be infeasible. Run FORCESdiagnostics on your problem to check for most common errors in the formulation.
      -10 - The convex solver could not proceed due to an internal error
+     -20 - Time limit reached (timelimit, see below)
     -100 - License error
 
    [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS) returns 
@@ -118,6 +119,45 @@ a Python wrapper for a fast solver generated by FORCES Pro v1.6.121
        INFO.solvetime - Time needed for solve (wall clock time)
        INFO.fevalstime - Time needed for function evaluations (wall clock time)
 
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, warmstart=W) replaces PARAMS['x0'] by
+   the last optimal solution of the calling thread if one is stored:
+       W = 0 - no warm start (default)
+       W = 1 - initial guess is the last optimal solution
+       W = 2 - same, shifted forward by one stage (last stage repeated)
+       W = 3 - initial guess is the cached optimal solution whose parameters are nearest
+               to PARAMS, else as W = 1 (see FORCESNLPsolver_set_cache)
+   FORCESNLPsolver_py.FORCESNLPsolver_reset_warmstart() forgets the stored solution.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(None) solves again with the parameters of the last
+   call of the calling thread, as changed by FORCESNLPsolver_set_param_slice and
+   FORCESNLPsolver_set_stage_params.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, packed=True) returns OUTPUT as one
+   array of size 24 x 61 (Fortran order) whose column s is stage xs; it can be passed
+   directly as the next PARAMS['x0'].
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, nthreads=N) runs the solve on N threads
+   if the library was built with FORCESNLPsolver_build.py --openmp (0: OpenMP default).
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, timelimit=T) stops the solver at its next
+   function evaluation once T seconds (wall clock) have passed, with EXITFLAG -20; OUTPUT is
+   the iterate it stopped at, check INFO['res_eq'] and INFO['res_ineq'] before using it.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, settings=S) with S a dictionary with any of
+   the keys acc_rdgap, acc_reseq, acc_resineq, acc_kktcompl (tolerances), fls_scale (line
+   search), maxit (iterations) and max_soc_it (second order corrections) overrides them for
+   this solve, if the library was built with FORCESNLPsolver_build.py --runtime-settings;
+   the rest keep their generated values. printlevel=0 silences the solve in any build.
+
+   After FORCESNLPsolver_py.FORCESNLPsolver_set_cache(MB), a solve whose xinit, xfinal,
+   all_parameters and settings (but printlevel) equal those of an earlier one returns its
+   stored result without calling the solver.
+
+   The library is picked once per process: FORCESNLPsolver_LIBRARY in the environment, if
+   set, is the path of the solver library to load and overrides the choice by instruction
+   set (FORCESNLPsolver_ISA names the instruction set instead). Otherwise the library found
+   is stored there, so that processes started from this one load the same library.
+
  See also COPYING
 
 '''
@@ -127,23 +167,111 @@ import os
 import numpy as np
 import numpy.ctypeslib as npct
 import sys
+import threading
 
 #_lib = ctypes.CDLL(os.path.join(os.getcwd(),'FORCESNLPsolver/lib/FORCESNLPsolver.so')) 
-try:
-	_lib = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)),'FORCESNLPsolver/lib/FORCESNLPsolver_withModel.so'))
-	csolver = getattr(_lib,'FORCESNLPsolver_solve')
-except:
-	_lib = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)),'FORCESNLPsolver/lib/libFORCESNLPsolver_withModel.so'))
-	csolver = getattr(_lib,'FORCESNLPsolver_solve')
+_libdir = os.path.join(os.path.dirname(os.path.abspath(__file__)),'FORCESNLPsolver/lib')
+
+def _cpu_isas():
+	'''
+instruction sets supported by the CPU, best first, named as in FORCESNLPsolver_build.py --isa-variants,
+None if they cannot be told on this platform (read from /proc/cpuinfo on Linux and from sysctl on
+macOS); FORCESNLPsolver_ISA in the environment overrides the detection
+	'''
+	if os.environ.get('FORCESNLPsolver_ISA'):
+		return [os.environ['FORCESNLPsolver_ISA']]
+	flags = None
+	if sys.platform.startswith('linux'):
+		try:
+			with open('/proc/cpuinfo') as cpuinfo:
+				for line in cpuinfo:
+					if line.startswith('flags'):
+						flags = set(line.split(':', 1)[1].split())
+						break
+		except (IOError, OSError):
+			pass
+	elif sys.platform == 'darwin':
+		import subprocess
+		try:
+			features = subprocess.check_output(['sysctl', '-n', 'machdep.cpu.features', 'machdep.cpu.leaf7_features'], stderr=subprocess.STDOUT)
+			flags = set(features.decode().lower().replace('avx1.0', 'avx').split())
+		except (OSError, subprocess.CalledProcessError):
+			pass
+	if flags is None:
+		return None
+	isas = []
+	if set(['avx512f', 'avx512dq', 'avx512vl', 'avx2', 'fma']) <= flags:
+		isas.append('avx512')
+	if set(['avx2', 'fma']) <= flags:
+		isas.append('avx2')
+	if 'avx' in flags:
+		isas.append('avx')
+	if 'sse2' in flags:
+		isas.append('sse2')
+	return isas
+
+def _find_library(names):
+	'''
+path of the first of names in the lib dir, None if there is none
+	'''
+	for name in names:
+		if os.path.exists(os.path.join(_libdir, name)):
+			return os.path.join(_libdir, name)
+	return None
+
+# The solver library variant for the best instruction set if built (FORCESNLPsolver_build.py
+# --isa-variants builds FORCESNLPsolver_<isa>), the model library FORCESNLPsolver_withModel
+# otherwise; the variants hold the solver only, so the external functions (CasADi model)
+# always come from the model library. FORCESNLPsolver_LIBRARY in the environment overrides
+# the choice; otherwise the choice goes there, if the library exists, so that worker
+# processes started from here load it without probing again
+_modelpath = _find_library(['FORCESNLPsolver_withModel.so', 'libFORCESNLPsolver_withModel.so']) or os.path.join(_libdir, 'FORCESNLPsolver_withModel.so')
+_libpath = os.environ.get('FORCESNLPsolver_LIBRARY')
+if not _libpath:
+	_variants = [_isa for _isa in ['avx512', 'avx2', 'avx', 'sse2'] if _find_library(['libFORCESNLPsolver_' + _isa + '.so', 'FORCESNLPsolver_' + _isa + '.so'])]
+	_isas = _cpu_isas() if _variants else []
+	if _isas is None:
+		sys.stderr.write('FORCESNLPsolver_py: cannot tell the instruction sets of this CPU, using the default library; ' +
+			'set FORCESNLPsolver_ISA to one of ' + ', '.join(_variants) + ' to load that variant\n')
+		_isas = []
+	_libpath = _modelpath
+	for _isa in _isas:
+		if _isa in _variants:
+			_libpath = _find_library(['libFORCESNLPsolver_' + _isa + '.so', 'FORCESNLPsolver_' + _isa + '.so'])
+			break
+	if os.path.exists(_libpath):
+		os.environ['FORCESNLPsolver_LIBRARY'] = _libpath
+_lib = ctypes.CDLL(_libpath)
+_modellib = _lib if hasattr(_lib, 'FORCESNLPsolver_casadi2forces') else ctypes.CDLL(_modelpath)
+csolver = getattr(_lib,'FORCESNLPsolver_solve')
+
+# external functions (CasADi model) passed to every solve, resolved once
+_extfunc = ctypes.cast(_modellib.FORCESNLPsolver_casadi2forces, ctypes.c_void_p)
+
+# floating point type the library was built with, float32 for FORCESNLPsolver_build.py --single
+_lib.FORCESNLPsolver_float_size.restype = ctypes.c_int
+_float_size = _lib.FORCESNLPsolver_float_size()
+FORCESNLPsolver_float = ctypes.c_float if _float_size == 4 else ctypes.c_double
+_npfloat = np.float32 if _float_size == 4 else np.float64
+
+# horizon and stage sizes the library was generated with, see FORCESNLPsolver_get_dims
+class FORCESNLPsolver_dims(ctypes.Structure):
+	_fields_ = [('nstages', ctypes.c_int), ('nvar', ctypes.c_int), ('npar', ctypes.c_int), ('nxinit', ctypes.c_int), ('nxfinal', ctypes.c_int)]
+
+_dims = FORCESNLPsolver_dims()
+_lib.FORCESNLPsolver_get_dims.argtypes = [ctypes.POINTER(FORCESNLPsolver_dims)]
+_lib.FORCESNLPsolver_get_dims.restype = None
+_lib.FORCESNLPsolver_get_dims(ctypes.byref(_dims))
+_nstages, _nvar, _npar = _dims.nstages, _dims.nvar, _dims.npar
 
 class FORCESNLPsolver_params_ctypes(ctypes.Structure):
 #	@classmethod
 #	def from_param(self):
 #		return self
-	_fields_ = [('x0', ctypes.c_double * 1464),
-('xinit', ctypes.c_double * 16),
-('xfinal', ctypes.c_double * 11),
-('all_parameters', ctypes.c_double * 2501),
+	_fields_ = [('x0', FORCESNLPsolver_float * 1464),
+('xinit', FORCESNLPsolver_float * 16),
+('xfinal', FORCESNLPsolver_float * 11),
+('all_parameters', FORCESNLPsolver_float * 2501),
 ]
 
 FORCESNLPsolver_params = {'x0' : np.array([]),
@@ -161,67 +289,67 @@ class FORCESNLPsolver_outputs_ctypes(ctypes.Structure):
 #	@classmethod
 #	def from_param(self):
 #		return self
-	_fields_ = [('x01', ctypes.c_double * 24),
-('x02', ctypes.c_double * 24),
-('x03', ctypes.c_double * 24),
-('x04', ctypes.c_double * 24),
-('x05', ctypes.c_double * 24),
-('x06', ctypes.c_double * 24),
-('x07', ctypes.c_double * 24),
-('x08', ctypes.c_double * 24),
-('x09', ctypes.c_double * 24),
-('x10', ctypes.c_double * 24),
-('x11', ctypes.c_double * 24),
-('x12', ctypes.c_double * 24),
-('x13', ctypes.c_double * 24),
-('x14', ctypes.c_double * 24),
-('x15', ctypes.c_double * 24),
-('x16', ctypes.c_double * 24),
-('x17', ctypes.c_double * 24),
-('x18', ctypes.c_double * 24),
-('x19', ctypes.c_double * 24),
-('x20', ctypes.c_double * 24),
-('x21', ctypes.c_double * 24),
-('x22', ctypes.c_double * 24),
-('x23', ctypes.c_double * 24),
-('x24', ctypes.c_double * 24),
-('x25', ctypes.c_double * 24),
-('x26', ctypes.c_double * 24),
-('x27', ctypes.c_double * 24),
-('x28', ctypes.c_double * 24),
-('x29', ctypes.c_double * 24),
-('x30', ctypes.c_double * 24),
-('x31', ctypes.c_double * 24),
-('x32', ctypes.c_double * 24),
-('x33', ctypes.c_double * 24),
-('x34', ctypes.c_double * 24),
-('x35', ctypes.c_double * 24),
-('x36', ctypes.c_double * 24),
-('x37', ctypes.c_double * 24),
-('x38', ctypes.c_double * 24),
-('x39', ctypes.c_double * 24),
-('x40', ctypes.c_double * 24),
-('x41', ctypes.c_double * 24),
-('x42', ctypes.c_double * 24),
-('x43', ctypes.c_double * 24),
-('x44', ctypes.c_double * 24),
-('x45', ctypes.c_double * 24),
-('x46', ctypes.c_double * 24),
-('x47', ctypes.c_double * 24),
-('x48', ctypes.c_double * 24),
-('x49', ctypes.c_double * 24),
-('x50', ctypes.c_double * 24),
-('x51', ctypes.c_double * 24),
-('x52', ctypes.c_double * 24),
-('x53', ctypes.c_double * 24),
-('x54', ctypes.c_double * 24),
-('x55', ctypes.c_double * 24),
-('x56', ctypes.c_double * 24),
-('x57', ctypes.c_double * 24),
-('x58', ctypes.c_double * 24),
-('x59', ctypes.c_double * 24),
-('x60', ctypes.c_double * 24),
-('x61', ctypes.c_double * 24),
+	_fields_ = [('x01', FORCESNLPsolver_float * 24),
+('x02', FORCESNLPsolver_float * 24),
+('x03', FORCESNLPsolver_float * 24),
+('x04', FORCESNLPsolver_float * 24),
+('x05', FORCESNLPsolver_float * 24),
+('x06', FORCESNLPsolver_float * 24),
+('x07', FORCESNLPsolver_float * 24),
+('x08', FORCESNLPsolver_float * 24),
+('x09', FORCESNLPsolver_float * 24),
+('x10', FORCESNLPsolver_float * 24),
+('x11', FORCESNLPsolver_float * 24),
+('x12', FORCESNLPsolver_float * 24),
+('x13', FORCESNLPsolver_float * 24),
+('x14', FORCESNLPsolver_float * 24),
+('x15', FORCESNLPsolver_float * 24),
+('x16', FORCESNLPsolver_float * 24),
+('x17', FORCESNLPsolver_float * 24),
+('x18', FORCESNLPsolver_float * 24),
+('x19', FORCESNLPsolver_float * 24),
+('x20', FORCESNLPsolver_float * 24),
+('x21', FORCESNLPsolver_float * 24),
+('x22', FORCESNLPsolver_float * 24),
+('x23', FORCESNLPsolver_float * 24),
+('x24', FORCESNLPsolver_float * 24),
+('x25', FORCESNLPsolver_float * 24),
+('x26', FORCESNLPsolver_float * 24),
+('x27', FORCESNLPsolver_float * 24),
+('x28', FORCESNLPsolver_float * 24),
+('x29', FORCESNLPsolver_float * 24),
+('x30', FORCESNLPsolver_float * 24),
+('x31', FORCESNLPsolver_float * 24),
+('x32', FORCESNLPsolver_float * 24),
+('x33', FORCESNLPsolver_float * 24),
+('x34', FORCESNLPsolver_float * 24),
+('x35', FORCESNLPsolver_float * 24),
+('x36', FORCESNLPsolver_float * 24),
+('x37', FORCESNLPsolver_float * 24),
+('x38', FORCESNLPsolver_float * 24),
+('x39', FORCESNLPsolver_float * 24),
+('x40', FORCESNLPsolver_float * 24),
+('x41', FORCESNLPsolver_float * 24),
+('x42', FORCESNLPsolver_float * 24),
+('x43', FORCESNLPsolver_float * 24),
+('x44', FORCESNLPsolver_float * 24),
+('x45', FORCESNLPsolver_float * 24),
+('x46', FORCESNLPsolver_float * 24),
+('x47', FORCESNLPsolver_float * 24),
+('x48', FORCESNLPsolver_float * 24),
+('x49', FORCESNLPsolver_float * 24),
+('x50', FORCESNLPsolver_float * 24),
+('x51', FORCESNLPsolver_float * 24),
+('x52', FORCESNLPsolver_float * 24),
+('x53', FORCESNLPsolver_float * 24),
+('x54', FORCESNLPsolver_float * 24),
+('x55', FORCESNLPsolver_float * 24),
+('x56', FORCESNLPsolver_float * 24),
+('x57', FORCESNLPsolver_float * 24),
+('x58', FORCESNLPsolver_float * 24),
+('x59', FORCESNLPsolver_float * 24),
+('x60', FORCESNLPsolver_float * 24),
+('x61', FORCESNLPsolver_float * 24),
 ]
 
 FORCESNLPsolver_outputs = {'x01' : np.array([]),
@@ -294,37 +422,315 @@ class FORCESNLPsolver_info(ctypes.Structure):
 #		return self
 	_fields_ = [('it', ctypes.c_int),
 ('it2opt', ctypes.c_int),
-('res_eq', ctypes.c_double),
-('res_ineq', ctypes.c_double),
-('rsnorm', ctypes.c_double),
-('rcompnorm', ctypes.c_double),
-('pobj',ctypes.c_double),
-('dobj',ctypes.c_double),
-('dgap',ctypes.c_double),
-('rdgap',ctypes.c_double),
-('mu',ctypes.c_double),
-('mu_aff',ctypes.c_double),
-('sigma',ctypes.c_double),
+('res_eq', FORCESNLPsolver_float),
+('res_ineq', FORCESNLPsolver_float),
+('rsnorm', FORCESNLPsolver_float),
+('rcompnorm', FORCESNLPsolver_float),
+('pobj',FORCESNLPsolver_float),
+('dobj',FORCESNLPsolver_float),
+('dgap',FORCESNLPsolver_float),
+('rdgap',FORCESNLPsolver_float),
+('mu',FORCESNLPsolver_float),
+('mu_aff',FORCESNLPsolver_float),
+('sigma',FORCESNLPsolver_float),
 ('lsit_aff', ctypes.c_int),
 ('lsit_cc', ctypes.c_int),
-('step_aff',ctypes.c_double),
-('step_cc',ctypes.c_double),
-('solvetime',ctypes.c_double),
-('fevalstime',ctypes.c_double)
+('step_aff',FORCESNLPsolver_float),
+('step_cc',FORCESNLPsolver_float),
+('solvetime',FORCESNLPsolver_float),
+('fevalstime',FORCESNLPsolver_float)
 ]
 
 class FILE(ctypes.Structure):
         pass
-if sys.version_info.major == 2:
-	PyFile_AsFile = ctypes.pythonapi.PyFile_AsFile # problem here with python 3 http://stackoverflow.com/questions/16130268/python-3-replacement-for-pyfile-asfile
-	PyFile_AsFile.argtypes = [ctypes.py_object]
-	PyFile_AsFile.restype = ctypes.POINTER(FILE)
+
+# receives the solver printout from memory, no temporary files involved
+FORCESNLPsolver_logfunc = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+
+def _print_log(userdata, text, size):
+	sys.stdout.write(ctypes.string_at(text, size).decode('utf-8', 'replace'))
+
+_print_log_c = FORCESNLPsolver_logfunc(_print_log)
+
+# completion callback of a submitted solve, see FORCESNLPsolver_submit
+FORCESNLPsolver_donefunc = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p)
+
+# cancellation and pinning of a batch, see FORCESNLPsolver_solve_batch
+FORCESNLPsolver_cancelfunc = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_int)
+
+class FORCESNLPsolver_batch_control(ctypes.Structure):
+	_fields_ = [('cancel', FORCESNLPsolver_cancelfunc),
+('canceluser', ctypes.c_void_p),
+('pin', ctypes.c_int),
+]
+
+def _batch_control(cancel, pin):
+	control = FORCESNLPsolver_batch_control()
+	if cancel is not None:
+		control.cancel = FORCESNLPsolver_cancelfunc(lambda userdata, k: 1 if cancel(k) else 0)
+	control.pin = 1 if pin else 0
+	return control
+
+# settings read at run time by a library built with --runtime-settings, see FORCESNLPsolver.h
+class FORCESNLPsolver_settings(ctypes.Structure):
+	_fields_ = [('acc_rdgap', FORCESNLPsolver_float),
+('acc_reseq', FORCESNLPsolver_float),
+('acc_resineq', FORCESNLPsolver_float),
+('acc_kktcompl', FORCESNLPsolver_float),
+('fls_scale', FORCESNLPsolver_float),
+('maxit', ctypes.c_int),
+('max_soc_it', ctypes.c_int),
+('printlevel', ctypes.c_int),
+]
+
+_settings_types = dict(FORCESNLPsolver_settings._fields_)
+
+# cumulative timings of the solves of a context, see FORCESNLPsolver_context.h
+class FORCESNLPsolver_profile(ctypes.Structure):
+	_fields_ = [('nsolves', ctypes.c_longlong),
+('iterations', ctypes.c_longlong),
+('solvetime', ctypes.c_double),
+('fevalstime', ctypes.c_double),
+('coretime', ctypes.c_double),
+('evals', ctypes.c_longlong * 61),
+('evaltime', ctypes.c_double * 61),
+]
+
+# sweeps of the last solve, see FORCESNLPsolver_context.h
+_trace_size = 128
+class FORCESNLPsolver_trace_entry(ctypes.Structure):
+	_fields_ = [('sweep', ctypes.c_int),
+('pobj', FORCESNLPsolver_float),
+('time', ctypes.c_double),
+]
+
+class FORCESNLPsolver_trace(ctypes.Structure):
+	_fields_ = [('entries', FORCESNLPsolver_trace_entry * _trace_size),
+('count', ctypes.c_int),
+]
+
+class FORCESNLPsolver_cache_stats(ctypes.Structure):
+	_fields_ = [('hits', ctypes.c_longlong),
+('misses', ctypes.c_longlong),
+('seeded', ctypes.c_longlong),
+('evictions', ctypes.c_longlong),
+('entries', ctypes.c_int),
+('capacity', ctypes.c_int),
+]
+
+# process-wide counters, see FORCESNLPsolver_metrics in FORCESNLPsolver_context.h
+_metrics_exitflags = ['OPTIMAL', 'MAXITREACHED', 'FACTORIZATION_ERROR', 'BADFUNCEVAL', 'NOPROGRESS', 'TIMELIMIT_REACHED', 'OTHER']
+_metrics_iterations = [5, 10, 20, 50, 100, 200, 500, 1000]
+_metrics_seconds = [1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1, 2.5, 5, 10]
+class FORCESNLPsolver_metrics(ctypes.Structure):
+	_fields_ = [('solves', ctypes.c_longlong * len(_metrics_exitflags)),
+('iterations', ctypes.c_longlong * (len(_metrics_iterations) + 1)),
+('solvetime', ctypes.c_longlong * (len(_metrics_seconds) + 1)),
+('fevalstime', ctypes.c_longlong * (len(_metrics_seconds) + 1)),
+('iterations_sum', ctypes.c_longlong),
+('solvetime_sum', ctypes.c_double),
+('fevalstime_sum', ctypes.c_double),
+('warmstarts', ctypes.c_longlong),
+('cache_hits', ctypes.c_longlong),
+('cache_misses', ctypes.c_longlong),
+]
+
+# leading members of FORCESNLPsolver_context, see FORCESNLPsolver_context.h
+class FORCESNLPsolver_context_ctypes(ctypes.Structure):
+	_fields_ = [('params', FORCESNLPsolver_params_ctypes),
+('output', FORCESNLPsolver_outputs_ctypes),
+('info', FORCESNLPsolver_info),
+('exitflag', ctypes.c_int),
+('extfunc', ctypes.c_void_p),
+('fs', ctypes.POINTER(FILE)),
+('warmstart', ctypes.c_int),
+]
 
 # determine data types for solver function prototype 
-csolver.argtypes = ( ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.POINTER(FORCESNLPsolver_outputs_ctypes), ctypes.POINTER(FORCESNLPsolver_info), ctypes.POINTER(FILE))
+csolver.argtypes = ( ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.POINTER(FORCESNLPsolver_outputs_ctypes), ctypes.POINTER(FORCESNLPsolver_info), ctypes.POINTER(FILE), ctypes.c_void_p)
 csolver.restype = ctypes.c_int
 
-def FORCESNLPsolver_solve(params_arg):
+# determine data types for solver context prototypes
+_lib.FORCESNLPsolver_create.argtypes = [ctypes.c_void_p]
+_lib.FORCESNLPsolver_create.restype = ctypes.POINTER(FORCESNLPsolver_context_ctypes)
+_lib.FORCESNLPsolver_destroy.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes)]
+_lib.FORCESNLPsolver_destroy.restype = None
+_lib.FORCESNLPsolver_solve_ctx.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes)]
+_lib.FORCESNLPsolver_solve_ctx.restype = ctypes.c_int
+_lib.FORCESNLPsolver_reset_warmstart.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes)]
+_lib.FORCESNLPsolver_reset_warmstart.restype = None
+_lib.FORCESNLPsolver_set_log.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), FORCESNLPsolver_logfunc, ctypes.c_void_p]
+_lib.FORCESNLPsolver_set_log.restype = None
+_lib.FORCESNLPsolver_solve_batch.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_info), ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+_lib.FORCESNLPsolver_solve_batch.restype = ctypes.c_int
+_lib.FORCESNLPsolver_set_param_slice.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+_lib.FORCESNLPsolver_set_param_slice.restype = ctypes.c_int
+_lib.FORCESNLPsolver_solve_batch_template.argtypes = [ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_info), ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+_lib.FORCESNLPsolver_solve_batch_template.restype = ctypes.c_int
+_lib.FORCESNLPsolver_solve_batch_control.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_info), ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_batch_control)]
+_lib.FORCESNLPsolver_solve_batch_control.restype = ctypes.c_int
+_lib.FORCESNLPsolver_solve_batch_template_control.argtypes = [ctypes.POINTER(FORCESNLPsolver_params_ctypes), ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_info), ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_batch_control)]
+_lib.FORCESNLPsolver_solve_batch_template_control.restype = ctypes.c_int
+_lib.FORCESNLPsolver_solve_batch_lanes.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_info), ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_batch_control)]
+_lib.FORCESNLPsolver_solve_batch_lanes.restype = ctypes.c_int
+_lib.FORCESNLPsolver_set_num_threads.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.c_int]
+_lib.FORCESNLPsolver_set_num_threads.restype = None
+_lib.FORCESNLPsolver_default_settings.argtypes = [ctypes.POINTER(FORCESNLPsolver_settings)]
+_lib.FORCESNLPsolver_default_settings.restype = None
+_lib.FORCESNLPsolver_set_settings.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.POINTER(FORCESNLPsolver_settings)]
+_lib.FORCESNLPsolver_set_settings.restype = None
+_lib.FORCESNLPsolver_set_time_limit.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), FORCESNLPsolver_float]
+_lib.FORCESNLPsolver_set_time_limit.restype = None
+_lib.FORCESNLPsolver_set_profile.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.POINTER(FORCESNLPsolver_profile)]
+_lib.FORCESNLPsolver_set_profile.restype = None
+_lib.FORCESNLPsolver_reset_profile.argtypes = [ctypes.POINTER(FORCESNLPsolver_profile)]
+_lib.FORCESNLPsolver_reset_profile.restype = None
+_lib.FORCESNLPsolver_set_trace.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.POINTER(FORCESNLPsolver_trace)]
+_lib.FORCESNLPsolver_set_trace.restype = None
+_lib.FORCESNLPsolver_sensitivity.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.c_void_p, ctypes.c_int, FORCESNLPsolver_float, ctypes.c_int, ctypes.c_void_p, ctypes.c_int]
+_lib.FORCESNLPsolver_sensitivity.restype = ctypes.c_int
+_lib.FORCESNLPsolver_sensitivity_fd.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, FORCESNLPsolver_float, ctypes.c_int, ctypes.c_void_p, ctypes.c_int]
+_lib.FORCESNLPsolver_sensitivity_fd.restype = ctypes.c_int
+# return codes of FORCESNLPsolver_sensitivity, see FORCESNLPsolver_context.h
+_sensitivity_no_memory = -2
+_sensitivity_nominal_failed = -3
+_lib.FORCESNLPsolver_cache_create.argtypes = [ctypes.c_size_t]
+_lib.FORCESNLPsolver_cache_create.restype = ctypes.c_void_p
+_lib.FORCESNLPsolver_cache_destroy.argtypes = [ctypes.c_void_p]
+_lib.FORCESNLPsolver_cache_destroy.restype = None
+_lib.FORCESNLPsolver_cache_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_cache_stats)]
+_lib.FORCESNLPsolver_cache_get_stats.restype = None
+_lib.FORCESNLPsolver_get_metrics.argtypes = [ctypes.POINTER(FORCESNLPsolver_metrics)]
+_lib.FORCESNLPsolver_get_metrics.restype = None
+_lib.FORCESNLPsolver_reset_metrics.argtypes = []
+_lib.FORCESNLPsolver_reset_metrics.restype = None
+_lib.FORCESNLPsolver_metrics_export.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+_lib.FORCESNLPsolver_metrics_export.restype = ctypes.c_size_t
+_lib.FORCESNLPsolver_set_cache.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes), ctypes.c_void_p]
+_lib.FORCESNLPsolver_set_cache.restype = None
+_lib.FORCESNLPsolver_pool_create.argtypes = [ctypes.c_int]
+_lib.FORCESNLPsolver_pool_create.restype = ctypes.c_void_p
+_lib.FORCESNLPsolver_submit.argtypes = [ctypes.c_void_p, ctypes.POINTER(FORCESNLPsolver_context_ctypes), FORCESNLPsolver_donefunc, ctypes.c_void_p]
+_lib.FORCESNLPsolver_submit.restype = ctypes.c_int
+_lib.FORCESNLPsolver_poll.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes)]
+_lib.FORCESNLPsolver_poll.restype = ctypes.c_int
+_lib.FORCESNLPsolver_wait.argtypes = [ctypes.POINTER(FORCESNLPsolver_context_ctypes)]
+_lib.FORCESNLPsolver_wait.restype = ctypes.c_int
+_lib.FORCESNLPsolver_resample_stages.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_lib.FORCESNLPsolver_resample_stages.restype = ctypes.c_int
+
+# parameter vectors in the order of FORCESNLPsolver_params
+_params_sizes = [('x0', _nstages*_nvar), ('xinit', _dims.nxinit), ('xfinal', _dims.nxfinal), ('all_parameters', _nstages*_npar)]
+_nparams = sum(size for (par, size) in _params_sizes)
+if ctypes.sizeof(FORCESNLPsolver_params_ctypes) != _nparams*_float_size or ctypes.sizeof(FORCESNLPsolver_outputs_ctypes) != _nstages*_nvar*_float_size:
+	raise ImportError(_libpath + ' was generated for another horizon than this wrapper')
+
+# zero-copy extension built next to the solver library, optional
+sys.path.insert(0, _libdir)
+try:
+	import FORCESNLPsolver_pyext as _pyext
+	if _pyext.float_size != _float_size:
+		raise ImportError('FORCESNLPsolver_pyext was built for another precision')
+	_pyext.bind(ctypes.cast(_lib.FORCESNLPsolver_solve_batch, ctypes.c_void_p).value, _extfunc.value)
+except ImportError:
+	_pyext = None
+finally:
+	sys.path.remove(_libdir)
+
+class FORCESNLPsolver_context(object):
+	'''
+owns one solver context of the C library, released when the object is collected
+	'''
+	def __init__(self, log=True):
+		self._destroy = _lib.FORCESNLPsolver_destroy
+		self.ptr = _lib.FORCESNLPsolver_create(_extfunc)
+		if not self.ptr:
+			raise MemoryError('Could not allocate solver context.')
+		if log:
+			_lib.FORCESNLPsolver_set_log(self.ptr, _print_log_c, None)
+		# filled by the C library while profiling is on
+		self.profile = FORCESNLPsolver_profile()
+		self.trace = FORCESNLPsolver_trace()
+
+	def __del__(self):
+		if getattr(self, 'ptr', None):
+			self._destroy(self.ptr)
+			self.ptr = None
+
+# one context per thread, so that threads can call FORCESNLPsolver_solve concurrently
+_contexts = threading.local()
+
+# result cache shared by the contexts of all threads, see FORCESNLPsolver_set_cache
+_cache = None
+
+def _get_context():
+	ctx = getattr(_contexts, 'ctx', None)
+	if ctx is None:
+		ctx = FORCESNLPsolver_context()
+		_contexts.ctx = ctx
+	return ctx
+
+# solver threads of FORCESNLPsolver_submit, started by its first call
+_pool = None
+_pool_lock = threading.Lock()
+
+# the solver threads do not survive a fork: a child process starts a pool of its own,
+# and the futures it inherited are void there, see _fork_generation
+_fork_generation = 0
+
+def _after_fork_in_child():
+	global _pool, _pool_lock, _fork_generation
+	_pool = None
+	_pool_lock = threading.Lock()
+	_fork_generation += 1
+
+if hasattr(os, 'register_at_fork'):
+	os.register_at_fork(after_in_child=_after_fork_in_child)
+
+def _set_options(ctxp, warmstart, nthreads, timelimit, settings):
+	ctxp.contents.warmstart = int(warmstart)
+	_lib.FORCESNLPsolver_set_num_threads(ctxp, int(nthreads))
+	_lib.FORCESNLPsolver_set_time_limit(ctxp, float(timelimit))
+	settings_c = FORCESNLPsolver_settings()
+	_lib.FORCESNLPsolver_default_settings(ctypes.byref(settings_c))
+	for name in (settings or {}):
+		if name not in _settings_types:
+			raise ValueError('Unknown setting ' + name + '.')
+		value = settings[name]
+		if _settings_types[name] is ctypes.c_int:
+			if value != int(value) or value < 0:
+				raise ValueError('Setting ' + name + ' must be a nonnegative integer.')
+			setattr(settings_c, name, int(value))
+		else:
+			setattr(settings_c, name, float(value))
+	_lib.FORCESNLPsolver_set_settings(ctxp, ctypes.byref(settings_c))
+	_lib.FORCESNLPsolver_set_cache(ctxp, _cache)
+
+def _set_params(ctx, params_arg):
+	# None keeps the parameters of the last call and later updates
+	params_py = ctx.params
+	if params_arg is not None:
+		ctypes.memset(ctypes.byref(params_py), 0, ctypes.sizeof(params_py))
+	for par in (params_arg or {}):
+		try:
+			#setattr(params_py, par, npct.as_ctypes(np.reshape(params_arg[par],np.size(params_arg[par]),order='A'))) 
+			params_arg[par] = np.require(params_arg[par], dtype=_npfloat, requirements='F')
+			setattr(params_py, par, npct.as_ctypes(np.reshape(params_arg[par],np.size(params_arg[par]),order='F')))  
+		except:
+			raise ValueError('Parameter ' + par + ' does not have the appropriate dimensions or data type. Please use numpy arrays for parameters.')
+
+def _get_results(ctx, packed):
+	# copied since the context is reused
+	if packed:
+		outputs = np.reshape(np.frombuffer(ctx.output, dtype=_npfloat).copy(), (_nvar, _nstages), order='F')
+	else:
+		outputs = {}
+		for out in FORCESNLPsolver_outputs:
+			outputs[out] = npct.as_array(getattr(ctx.output,out)).copy()
+	info_py = FORCESNLPsolver_info.from_buffer_copy(ctx.info)
+	return outputs,int(ctx.exitflag),info_py
+
+def FORCESNLPsolver_solve(params_arg, warmstart=0, packed=False, nthreads=0, timelimit=0, settings=None):
 	'''
 a Python wrapper for a fast solver generated by FORCES Pro v1.6.121
 
@@ -408,6 +814,7 @@ a Python wrapper for a fast solver generated by FORCES Pro v1.6.121
       -6 - NaN or INF occured during evaluation of functions and derivatives. Please check your initial guess.
       -7 - Method could not progress. Problem may be infeasible. Run FORCESdiagnostics on your problem to check for most common errors in the formulation.
      -10 - The convex solver could not proceed due to an internal error
+     -20 - Time limit reached (timelimit, see below)
     -100 - License error
 
    [OUTPUT, EXITFLAG, INFO] = FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS) returns 
@@ -423,69 +830,540 @@ a Python wrapper for a fast solver generated by FORCES Pro v1.6.121
        INFO.solvetime - Time needed for solve (wall clock time)
        INFO.fevalstime - Time needed for function evaluations (wall clock time)
 
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, warmstart=W) replaces PARAMS['x0'] by
+   the last optimal solution of the calling thread if one is stored:
+       W = 0 - no warm start (default)
+       W = 1 - initial guess is the last optimal solution
+       W = 2 - same, shifted forward by one stage (last stage repeated)
+       W = 3 - initial guess is the cached optimal solution whose parameters are nearest
+               to PARAMS, else as W = 1 (see FORCESNLPsolver_set_cache)
+   FORCESNLPsolver_py.FORCESNLPsolver_reset_warmstart() forgets the stored solution.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(None) solves again with the parameters of the last
+   call of the calling thread, as changed by FORCESNLPsolver_set_param_slice and
+   FORCESNLPsolver_set_stage_params.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, packed=True) returns OUTPUT as one
+   array of size 24 x 61 (Fortran order) whose column s is stage xs; it can be passed
+   directly as the next PARAMS['x0'].
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, nthreads=N) runs the solve on N threads
+   if the library was built with FORCESNLPsolver_build.py --openmp (0: OpenMP default).
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, timelimit=T) stops the solver at its next
+   function evaluation once T seconds (wall clock) have passed, with EXITFLAG -20; OUTPUT is
+   the iterate it stopped at, check INFO['res_eq'] and INFO['res_ineq'] before using it.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_solve(PARAMS, settings=S) with S a dictionary with any of
+   the keys acc_rdgap, acc_reseq, acc_resineq, acc_kktcompl (tolerances), fls_scale (line
+   search), maxit (iterations) and max_soc_it (second order corrections) overrides them for
+   this solve, if the library was built with FORCESNLPsolver_build.py --runtime-settings;
+   the rest keep their generated values. printlevel=0 silences the solve in any build.
+
+   After FORCESNLPsolver_py.FORCESNLPsolver_set_cache(MB), a solve whose xinit, xfinal,
+   all_parameters and settings (but printlevel) equal those of an earlier one returns its
+   stored result without calling the solver.
+
  See also COPYING
 
 	'''
 	global _lib
 
-	# convert parameters
-	params_py = FORCESNLPsolver_params_ctypes()
-	for par in params_arg:
-		try:
-			#setattr(params_py, par, npct.as_ctypes(np.reshape(params_arg[par],np.size(params_arg[par]),order='A'))) 
-			params_arg[par] = np.require(params_arg[par], dtype=np.float64, requirements='F')
-			setattr(params_py, par, npct.as_ctypes(np.reshape(params_arg[par],np.size(params_arg[par]),order='F')))  
-		except:
-			raise ValueError('Parameter ' + par + ' does not have the appropriate dimensions or data type. Please use numpy arrays for parameters.')
+	# solver context of the calling thread
+	ctxp = _get_context().ptr
+	_set_options(ctxp, warmstart, nthreads, timelimit, settings)
+	_set_params(ctxp.contents, params_arg)
     
-	outputs_py = FORCESNLPsolver_outputs_ctypes()
-	info_py = FORCESNLPsolver_info()
-	if sys.version_info.major == 2:
-		if sys.platform.startswith('win'):
-			fp = None # if set to none, the solver prints to stdout by default - necessary because we have an access violation otherwise under windows
-		else:
-			#fp = open('stdout_temp.txt','w')
-			fp = sys.stdout
-		try:
-			PyFile_AsFile.restype = ctypes.POINTER(FILE)
-			exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), PyFile_AsFile(fp) , _lib.FORCESNLPsolver_casadi2forces )
-			#fp = open('stdout_temp.txt','r')
-			#print (fp.read())
-			#fp.close()
-		except:
-			#print 'Problem with solver'
-			raise
-	elif sys.version_info.major == 3:
-		if sys.platform.startswith('win'):
-			libc = ctypes.cdll.msvcrt
-		elif sys.platform.startswith('darwin'):
-			libc = ctypes.CDLL('libc.dylib')
-		else:
-			libc = ctypes.CDLL('libc.so.6')       # Open libc
-		cfopen = getattr(libc,'fopen')        # Get its fopen
-		cfopen.restype = ctypes.POINTER(FILE) # Yes, fopen gives a file pointer
-		cfopen.argtypes = [ctypes.c_char_p, ctypes.c_char_p] # Yes, fopen gives a file pointer 
-		fp = cfopen('stdout_temp.txt'.encode('utf-8'),'w'.encode('utf-8'))    # Use that fopen 
+	# call solver, printout is forwarded by _print_log
+	_lib.FORCESNLPsolver_solve_ctx( ctxp )
 
-		try:
-			if sys.platform.startswith('win'):
-				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), None , _lib.FORCESNLPsolver_casadi2forces)
-			else:
-				exitflag = _lib.FORCESNLPsolver_solve( params_py, ctypes.byref(outputs_py), ctypes.byref(info_py), fp , _lib.FORCESNLPsolver_casadi2forces)
-			libc.fclose(fp)
-			fptemp = open('stdout_temp.txt','r')
-			print (fptemp.read())
-			fptemp.close()			
-		except:
-			#print 'Problem with solver'
-			raise
+	return _get_results(ctxp.contents, packed)
+
+class FORCESNLPsolver_future(object):
+	'''
+a solve started by FORCESNLPsolver_submit, owns its solver context
+	'''
+	def __init__(self, context, packed, callback):
+		self._context = context
+		self._packed = packed
+		self._wait = _lib.FORCESNLPsolver_wait
+		self._generation = _fork_generation
+		def done(userdata, ctxp):
+			callback(*_get_results(context.ptr.contents, packed))
+		# kept alive until the solve has finished
+		self._done_c = FORCESNLPsolver_donefunc(done) if callback is not None else FORCESNLPsolver_donefunc()
+
+	def _check_process(self):
+		if self._generation != _fork_generation:
+			raise RuntimeError('The solve was submitted by the parent process.')
+
+	def done(self):
+		self._check_process()
+		return bool(_lib.FORCESNLPsolver_poll(self._context.ptr))
+
+	def result(self):
+		self._check_process()
+		self._wait(self._context.ptr)
+		return _get_results(self._context.ptr.contents, self._packed)
+
+	def __del__(self):
+		# the context must outlive its solve, which never finishes in a forked child
+		if getattr(self, '_context', None) is not None and self._generation == _fork_generation:
+			self._wait(self._context.ptr)
+
+def FORCESNLPsolver_submit(params_arg, warmstart=0, packed=False, timelimit=0, settings=None, callback=None):
+	'''
+   FUTURE = FORCESNLPsolver_py.FORCESNLPsolver_submit(PARAMS) starts solving PARAMS on a pool
+   of solver threads (one per processor) and returns at once; PARAMS and the keyword
+   arguments are those of FORCESNLPsolver_solve. There is no stored solution to warm start
+   from, except with warmstart=3 and a cache. The solver prints nothing.
+
+   FUTURE.done() is True once the solve has finished, FUTURE.result() waits for it and
+   returns OUTPUT, EXITFLAG, INFO like FORCESNLPsolver_solve.
+
+   FORCESNLPsolver_py.FORCESNLPsolver_submit(PARAMS, callback=F) calls F(OUTPUT, EXITFLAG, INFO)
+   on the solver thread when the solve has finished; F must not call FUTURE.result().
+	'''
+	global _pool
+	with _pool_lock:
+		if _pool is None:
+			_pool = _lib.FORCESNLPsolver_pool_create(0)
+			if not _pool:
+				raise MemoryError('Could not start the solver threads.')
+
+	context = FORCESNLPsolver_context(log=False)
+	_set_options(context.ptr, warmstart, 0, timelimit, settings)
+	_set_params(context.ptr.contents, params_arg)
+	future = FORCESNLPsolver_future(context, packed, callback)
+	_lib.FORCESNLPsolver_submit(_pool, context.ptr, future._done_c, None)
+	return future
 
-	# convert outputs
+def FORCESNLPsolver_solve_batch(params_arg, nthreads=0, packed=False, cancel=None, pin=False):
+	'''
+   OUTPUT, EXITFLAG, INFO = FORCESNLPsolver_py.FORCESNLPsolver_solve_batch(PARAMS, NTHREADS) solves
+   one problem per column of PARAMS['all_parameters'] (size 2501 x K) on NTHREADS threads
+   (0: one per processor). PARAMS['x0'], PARAMS['xinit'] and PARAMS['xfinal'] have one
+   column shared by all problems or K columns. Returns
+       OUTPUT['x01'] ... OUTPUT['x61'] - arrays of size 24 x K
+       EXITFLAG - integer array of size K
+       INFO - array of K FORCESNLPsolver_info structures
+   With packed=True, OUTPUT is one array of size 24 x 61 x K (Fortran order).
+
+   Problems are handed out to the threads one at a time. With cancel=F, F(k) is called
+   (from the solver threads) before problem k starts; if it returns True the problem is
+   skipped with EXITFLAG -21. With pin=True, thread i only runs on the i-th processor
+   (Linux and Windows), which keeps its memory on its NUMA node.
+	'''
+	global _lib
+
+	# stack parameters interleaved, problem k is column k of a C-ordered 3992 x K array,
+	# shared columns are broadcast
+	K = int(np.size(params_arg['all_parameters']) // (_nstages*_npar))
+	lanes = np.zeros((_nparams, K), dtype=_npfloat)
+	offset = 0
+	for (par, size) in _params_sizes:
+		if par in params_arg:
+			try:
+				value = np.reshape(np.require(params_arg[par], dtype=_npfloat), (size, -1), order='F')
+				if value.shape[1] not in (1, K):
+					raise ValueError()
+				lanes[offset:offset+size, :] = value
+			except:
+				raise ValueError('Parameter ' + par + ' must have ' + str(size) + ' rows and 1 or ' + str(K) + ' columns.')
+		offset += size
+
+	outputs_lanes = np.empty((_nstages*_nvar, K), dtype=_npfloat)
+	exitflags = np.empty(K, dtype=np.int32)
+	infos = (FORCESNLPsolver_info * K)()
+	control = _batch_control(cancel, pin)
+	_lib.FORCESNLPsolver_solve_batch_lanes( lanes.ctypes.data, outputs_lanes.ctypes.data, infos, exitflags.ctypes.data, K, int(nthreads), _extfunc, ctypes.byref(control) )
+
+	# convert outputs, stage xNN of problem k is column k
+	if packed:
+		return np.reshape(outputs_lanes, (_nstages, _nvar, K)).transpose(1, 0, 2),exitflags,infos
+	outputs = {}
 	for out in FORCESNLPsolver_outputs:
-		FORCESNLPsolver_outputs[out] = npct.as_array(getattr(outputs_py,out))
+		stage = int(out[1:]) - 1
+		outputs[out] = outputs_lanes[_nvar*stage:_nvar*(stage+1), :]
+
+	return outputs,exitflags,infos
+
+def FORCESNLPsolver_solve_batch_template(params_arg, first, length, stride, overrides, nthreads=0, packed=False, cancel=None, pin=False):
+	'''
+   OUTPUT, EXITFLAG, INFO = FORCESNLPsolver_py.FORCESNLPsolver_solve_batch_template(PARAMS, FIRST, LEN, STRIDE, OVERRIDES, NTHREADS)
+   solves one problem per column of OVERRIDES (size LEN*NB x K). All problems share PARAMS
+   (single columns), except for NB blocks of LEN values of all_parameters: block j of problem k
+   is OVERRIDES[j*LEN:(j+1)*LEN, k] and goes to all_parameters[FIRST + j*STRIDE:][:LEN].
+   Only OVERRIDES is stored per problem. Returns the same as FORCESNLPsolver_solve_batch,
+   cancel and pin as there.
+	'''
+	global _lib
+
+	params_py = FORCESNLPsolver_params_ctypes()
+	for (par, size) in _params_sizes:
+		if par in params_arg:
+			value = np.ascontiguousarray(params_arg[par], dtype=_npfloat).ravel(order='F')
+			if value.size != size:
+				raise ValueError('Parameter ' + par + ' must have ' + str(size) + ' elements.')
+			ctypes.memmove(getattr(params_py, par), value.ctypes.data, _float_size*size)
+
+	# problem k reads column k, stored contiguously
+	overrides = np.asfortranarray(overrides, dtype=_npfloat)
+	if overrides.ndim == 1:
+		overrides = overrides.reshape((-1, 1), order='F')
+	if length <= 0 or overrides.shape[0] % length != 0:
+		raise ValueError('OVERRIDES must have a multiple of LEN rows')
+	K = overrides.shape[1]
+
+	outputs_packed = np.empty((K, _nstages*_nvar), dtype=_npfloat)
+	exitflags = np.empty(K, dtype=np.int32)
+	infos = (FORCESNLPsolver_info * K)()
+	control = _batch_control(cancel, pin)
+	if _lib.FORCESNLPsolver_solve_batch_template_control( ctypes.byref(params_py), int(first), int(length), int(stride), overrides.shape[0] // length, overrides.ctypes.data,
+	                                                      outputs_packed.ctypes.data, infos, exitflags.ctypes.data, K, int(nthreads), _extfunc, ctypes.byref(control) ) < 0:
+		raise ValueError('blocks overlap or exceed all_parameters')
+
+	if packed:
+		return np.reshape(outputs_packed.T, (_nvar, _nstages, K), order='F'),exitflags,infos
+	outputs = {}
+	for out in FORCESNLPsolver_outputs:
+		stage = int(out[1:]) - 1
+		outputs[out] = outputs_packed[:, _nvar*stage:_nvar*(stage+1)].T
+
+	return outputs,exitflags,infos
+
+def FORCESNLPsolver_set_param_slice(first, length, stride, values):
+	'''
+   FORCESNLPsolver_py.FORCESNLPsolver_set_param_slice(FIRST, LEN, STRIDE, VALUES) overwrites
+   part of all_parameters stored for the calling thread: block j of LEN values of VALUES goes
+   to all_parameters[FIRST + j*STRIDE : FIRST + j*STRIDE + LEN]. The next
+   FORCESNLPsolver_solve(None) solves with the updated parameters.
+	'''
+	values = np.ascontiguousarray(values, dtype=_npfloat).ravel()
+	if length <= 0 or values.size % length != 0:
+		raise ValueError('values must hold a multiple of length elements')
+	if _lib.FORCESNLPsolver_set_param_slice(_get_context().ptr, int(first), int(length), int(stride), values.size // length, values.ctypes.data) != 0:
+		raise ValueError('blocks overlap or exceed all_parameters')
+
+def FORCESNLPsolver_set_stage_params(stage, values):
+	'''
+   FORCESNLPsolver_py.FORCESNLPsolver_set_stage_params(STAGE, VALUES) overwrites the 41 runtime
+   parameters of STAGE (0..60) stored for the calling thread.
+	'''
+	if not 0 <= stage < _nstages:
+		raise ValueError('stage must be in 0..' + str(_nstages - 1))
+	FORCESNLPsolver_set_param_slice(_npar*stage, _npar, _npar, values)
+
+def FORCESNLPsolver_reset_warmstart():
+	'''
+forgets the warm start solution stored for the calling thread
+	'''
+	_lib.FORCESNLPsolver_reset_warmstart(_get_context().ptr)
+
+def FORCESNLPsolver_set_profile(enable=True):
+	'''
+resets the timings of the calling thread and starts (enable=True) or stops collecting them
+	'''
+	ctx = _get_context()
+	_lib.FORCESNLPsolver_reset_profile(ctypes.byref(ctx.profile))
+	_lib.FORCESNLPsolver_set_profile(ctx.ptr, ctypes.byref(ctx.profile) if enable else None)
+
+def FORCESNLPsolver_get_profile():
+	'''
+   PROFILE = FORCESNLPsolver_py.FORCESNLPsolver_get_profile() returns the timings of the
+   solves of the calling thread since FORCESNLPsolver_set_profile (wall clock seconds):
+       PROFILE['nsolves'], PROFILE['iterations'] - number of solves and iterations
+       PROFILE['solvetime']  - time of the solves
+       PROFILE['fevalstime'] - time in the function evaluations (CasADi model)
+       PROFILE['coretime']   - the rest: KKT assembly, factorization, line search,
+                               second order corrections and filter
+       PROFILE['evals'], PROFILE['evaltime'] - evaluations and their time by stage (61);
+                               line search steps evaluate again, so evals / iterations
+                               above one shows their share
+	'''
+	prof = _get_context().profile
+	return {'nsolves': prof.nsolves, 'iterations': prof.iterations, 'solvetime': prof.solvetime,
+		'fevalstime': prof.fevalstime, 'coretime': prof.coretime,
+		'evals': np.array(prof.evals[:], dtype=np.int64), 'evaltime': np.array(prof.evaltime[:])}
+
+def FORCESNLPsolver_set_trace(enable=True):
+	'''
+starts (enable=True) or stops recording the sweeps of each solve of the calling thread
+	'''
+	ctx = _get_context()
+	_lib.FORCESNLPsolver_set_trace(ctx.ptr, ctypes.byref(ctx.trace) if enable else None)
+
+def FORCESNLPsolver_get_trace():
+	'''
+   TRACE = FORCESNLPsolver_py.FORCESNLPsolver_get_trace() returns the sweeps of the core over
+   the 61 stages (one per iterate and per line search trial point) of the last solve of the
+   calling thread, oldest first, as a structured array with the fields
+       TRACE['sweep'] - number of the sweep in the solve, from 0
+       TRACE['time']  - seconds since the start of the solve
+       TRACE['pobj']  - objective of the evaluated point
+   The last 128 sweeps are kept.
+	'''
+	trace = _get_context().trace
+	rows = min(trace.count, _trace_size)
+	result = np.zeros(rows, dtype=[('sweep', np.int32), ('time', np.float64), ('pobj', _npfloat)])
+	for i in range(rows):
+		entry = trace.entries[(trace.count - rows + i) % _trace_size]
+		result[i] = (entry.sweep, entry.time, entry.pobj)
+	return result
+
+# record files, see FORCESNLPsolver_record.h
+_record_header_dtype = np.dtype([('magic', 'S8'), ('version', '=u4'), ('byteorder', '=u4'), ('header_size', '=u4'), ('record_size', '=u4'), ('dims', '=u4', (6,)), ('reserved', '=u4', (4,))])
+_record_dtype = np.dtype([(par, np.float64, (size,)) for (par, size) in _params_sizes] + [
+	('output', np.float64, (_nstages*_nvar,)), ('info', np.float64, (19,)), ('exitflag', np.float64)])
+
+def FORCESNLPsolver_sensitivity(directions, lossgrad=None, step=0, nthreads=0, onesided=False):
+	'''
+   DX = FORCESNLPsolver_py.FORCESNLPsolver_sensitivity(DIRECTIONS) returns the derivatives of
+   the solution of the last FORCESNLPsolver_solve of the calling thread along the columns of
+   DIRECTIONS (size 2501 x K, or a vector of 2501) of all_parameters, as an array of size
+   1464 x K stacked like x0. The last solve must have ended with EXITFLAG 1.
+   With LOSSGRAD, the gradient of a loss w.r.t. the solution (1464 values), returns
+   LOSSGRAD' * DX of length K instead. That is the same K columns contracted, not an
+   adjoint: it costs as many solves, and a gradient w.r.t. all of all_parameters takes
+   2501 columns.
+   Central differences with STEP (0: 1e-4, 5e-3 in single precision), two full solves per
+   column and one for the refined solution, 2*K + 1 in all; with ONESIDED, forward
+   differences against the refined solution, K + 1 solves at a truncation error of STEP
+   instead of STEP^2. The solution is first refined at tolerances of 1e-3 * STEP and the perturbed
+   solves start from it at the same tolerances (only tightened in a build with runtime
+   settings; otherwise keep STEP well above the compiled tolerances), on NTHREADS
+   threads (0: one per processor). Columns whose solves failed are NaN.
+	'''
+	ctxp = _get_context().ptr
+	directions = np.asfortranarray(directions, dtype=_npfloat)
+	if directions.ndim == 1:
+		directions = directions.reshape((-1, 1), order='F')
+	if directions.ndim != 2 or directions.shape[0] != _nstages*_npar:
+		raise ValueError('directions must have ' + str(_nstages*_npar) + ' rows')
+	ndir = directions.shape[1]
+	if lossgrad is None:
+		result = np.zeros((_nstages*_nvar, ndir), dtype=_npfloat, order='F')
+		n = _lib.FORCESNLPsolver_sensitivity(ctxp, directions.ctypes.data, ndir, float(step), int(bool(onesided)), result.ctypes.data, int(nthreads))
+	else:
+		lossgrad = np.ascontiguousarray(lossgrad, dtype=_npfloat).ravel()
+		if lossgrad.size != _nstages*_nvar:
+			raise ValueError('lossgrad must hold ' + str(_nstages*_nvar) + ' values')
+		result = np.zeros(ndir, dtype=_npfloat)
+		n = _lib.FORCESNLPsolver_sensitivity_fd(ctxp, lossgrad.ctypes.data, directions.ctypes.data, ndir, float(step), int(bool(onesided)), result.ctypes.data, int(nthreads))
+	if n == _sensitivity_no_memory:
+		raise MemoryError('out of memory')
+	if n == _sensitivity_nominal_failed:
+		raise ValueError('the last solution could not be refined to the tolerances of step, use a larger step')
+	if n < 0:
+		raise ValueError('the last solve did not end with EXITFLAG 1')
+	return result
+
+def FORCESNLPsolver_set_cache(megabytes):
+	'''
+   FORCESNLPsolver_py.FORCESNLPsolver_set_cache(MB) keeps the results of the following solves
+   of all threads in a cache of at most MB megabytes (about 32 entries per MB in double
+   precision), the least recently used go first; MB = 0 drops the cache. Solves with a time
+   limit bypass the cache, and a cached result leaves an empty trace. Replaces an earlier
+   cache, so call it while no other thread
+   solves and no submitted solve runs.
+	'''
+	global _cache
+	if _cache is not None:
+		_lib.FORCESNLPsolver_cache_destroy(_cache)
+		_cache = None
+	if megabytes > 0:
+		_cache = _lib.FORCESNLPsolver_cache_create(int(megabytes * 1024 * 1024))
+		if not _cache:
+			raise MemoryError('Could not allocate a solve cache of ' + str(megabytes) + ' MB.')
+	_lib.FORCESNLPsolver_set_cache(_get_context().ptr, _cache)
+
+def FORCESNLPsolver_get_cache_stats():
+	'''
+   STATS = FORCESNLPsolver_py.FORCESNLPsolver_get_cache_stats() returns the counters of the cache:
+       STATS['hits'], STATS['misses'] - solves answered from the cache, and solved
+       STATS['seeded']    - misses warm started from a cached solution (warmstart=3)
+       STATS['evictions'] - entries dropped to make room
+       STATS['entries'], STATS['capacity'] - entries stored, and room for
+   None if there is no cache.
+	'''
+	if _cache is None:
+		return None
+	stats = FORCESNLPsolver_cache_stats()
+	_lib.FORCESNLPsolver_cache_get_stats(_cache, ctypes.byref(stats))
+	return dict((field[0], getattr(stats, field[0])) for field in FORCESNLPsolver_cache_stats._fields_)
+
+def FORCESNLPsolver_get_metrics():
+	'''
+   METRICS = FORCESNLPsolver_py.FORCESNLPsolver_get_metrics() returns the counters of all
+   solves of the process (all threads, batches and wrappers of this library):
+       METRICS['solves'] - solves of the core by exitflag name ('OPTIMAL', 'MAXITREACHED',
+                           'FACTORIZATION_ERROR', 'BADFUNCEVAL', 'NOPROGRESS',
+                           'TIMELIMIT_REACHED', 'OTHER'); cache answers are not solves
+       METRICS['iterations'], METRICS['solvetime'], METRICS['fevalstime'] - histograms of
+                           the same solves, lists of (upper bound, count) with the
+                           counts per bucket and float('inf') as the last bound
+       METRICS['iterations_sum'], METRICS['solvetime_sum'], METRICS['fevalstime_sum']
+       METRICS['warmstarts'] - solves started from a stored or cached solution
+       METRICS['cache_hits'], METRICS['cache_misses'] - solve cache lookups
+	'''
+	m = FORCESNLPsolver_metrics()
+	_lib.FORCESNLPsolver_get_metrics(ctypes.byref(m))
+	histogram = lambda bounds, counts: list(zip(bounds + [float('inf')], counts[:]))
+	return {'solves': dict(zip(_metrics_exitflags, m.solves[:])),
+		'iterations': histogram(_metrics_iterations, m.iterations), 'solvetime': histogram(_metrics_seconds, m.solvetime),
+		'fevalstime': histogram(_metrics_seconds, m.fevalstime), 'iterations_sum': m.iterations_sum,
+		'solvetime_sum': m.solvetime_sum, 'fevalstime_sum': m.fevalstime_sum, 'warmstarts': m.warmstarts,
+		'cache_hits': m.cache_hits, 'cache_misses': m.cache_misses}
+
+def FORCESNLPsolver_metrics_text():
+	'''
+returns the process-wide counters in the Prometheus text exposition format, for a metrics endpoint
+	'''
+	size = _lib.FORCESNLPsolver_metrics_export(None, 0) + 256
+	buf = ctypes.create_string_buffer(size)
+	_lib.FORCESNLPsolver_metrics_export(buf, size)
+	return buf.value.decode('ascii')
+
+def FORCESNLPsolver_reset_metrics():
+	'''
+zeroes the process-wide counters
+	'''
+	_lib.FORCESNLPsolver_reset_metrics()
+
+def FORCESNLPsolver_read_records(path):
+	'''
+   RECORDS = FORCESNLPsolver_py.FORCESNLPsolver_read_records(PATH) maps the record file PATH
+   (see FORCESNLPsolver_record.h) read-only into memory and returns its records as a structured
+   array with the fields x0, xinit, xfinal, all_parameters, output, info (19 values in the order
+   of FORCESNLPsolver_info) and exitflag, all float64. Nothing is read until it is used.
+	'''
+	header = np.fromfile(path, dtype=_record_header_dtype, count=1)
+	if len(header) != 1 or header['magic'][0] != b'FNLPREC' or header['version'][0] != 1 or header['byteorder'][0] != 0x01020304 \
+		or header['record_size'][0] != _record_dtype.itemsize or list(header['dims'][0]) != [1464, 16, 11, 2501, 1464, 19]:
+		raise ValueError(path + ' is not a record file of FORCESNLPsolver')
+	offset = int(header['header_size'][0])
+	count = (os.path.getsize(path) - offset) // _record_dtype.itemsize
+	if count == 0:
+		return np.zeros(0, dtype=_record_dtype)
+	return np.memmap(path, dtype=_record_dtype, mode='r', offset=offset, shape=(count,))
+
+def FORCESNLPsolver_solve_into(x0, xinit, xfinal, all_parameters, out, info=None):
+	'''
+   EXITFLAG = FORCESNLPsolver_py.FORCESNLPsolver_solve_into(X0, XINIT, XFINAL, ALL_PARAMETERS, OUT, INFO)
+   solves without converting through dictionaries and ctypes structures. All arguments
+   are C-contiguous float64 arrays (float32 for a single precision build; INFO is always
+   float64) or other buffers that are read and written in place:
+       X0 - 1464 values, XINIT - 16 values, XFINAL - 11 values, ALL_PARAMETERS - 2501 values
+       OUT - preallocated, 1464 values (e.g. 61 x 24), receives x01 ... x61 stage by stage
+       INFO - optional, preallocated, 10 values, receives it, it2opt, res_eq, res_ineq,
+              rsnorm, rcompnorm, pobj, mu, solvetime, fevalstime
+   Uses the compiled FORCESNLPsolver_pyext module if it was built, ctypes otherwise.
+   No warm start and no printout.
+	'''
+	if _pyext is not None:
+		return _pyext.solve(x0, xinit, xfinal, all_parameters, out, info)
+
+	params_py = FORCESNLPsolver_params_ctypes()
+	for (par, size), value in zip(_params_sizes, (x0, xinit, xfinal, all_parameters)):
+		value = np.asarray(value)
+		if value.dtype != _npfloat or not value.flags['C_CONTIGUOUS'] or value.size != size:
+			raise ValueError(par + ' must be a C-contiguous array of ' + str(size) + ' values of the solver precision')
+		ctypes.memmove(getattr(params_py, par), value.ctypes.data, _float_size*size)
+	if not (isinstance(out, np.ndarray) and out.dtype == _npfloat and out.size == _nstages*_nvar and out.flags['C_CONTIGUOUS'] and out.flags['WRITEABLE']):
+		raise ValueError('out must be a C-contiguous writable array of ' + str(_nstages*_nvar) + ' values of the solver precision')
+	info_py = FORCESNLPsolver_info()
+	exitflag = ctypes.c_int()
+	_lib.FORCESNLPsolver_solve_batch( ctypes.addressof(params_py), out.ctypes.data, info_py, ctypes.addressof(exitflag), 1, 1, _extfunc )
+	if info is not None:
+		info[:] = [info_py.it, info_py.it2opt, info_py.res_eq, info_py.res_ineq, info_py.rsnorm, info_py.rcompnorm, info_py.pobj, info_py.mu, info_py.solvetime, info_py.fevalstime]
+	return int(exitflag.value)
+
+def FORCESNLPsolver_get_dims():
+	'''
+   DIMS = FORCESNLPsolver_py.FORCESNLPsolver_get_dims() returns the dimensions the solver
+   was generated with: DIMS['nstages'] stages of DIMS['nvar'] variables and DIMS['npar']
+   runtime parameters each, DIMS['nxinit'] initial and DIMS['nxfinal'] final conditions.
+   The sizes of x0, all_parameters and the outputs follow from them.
+	'''
+	return dict((name, getattr(_dims, name)) for (name, _) in FORCESNLPsolver_dims._fields_)
+
+def FORCESNLPsolver_resample_stages(values, nstages):
+	'''
+   Y = FORCESNLPsolver_py.FORCESNLPsolver_resample_stages(X, N) interpolates the stage
+   vectors X (size W x M, column s is stage s) linearly onto N stages spanning the same
+   time, first and last stage unchanged, and returns them as an array of size W x N.
+   E.g. the solution of a solver of another horizon as x0 of this one:
+       x0 = resample_stages(np.reshape(other_output, (24, -1), order='F'), 61)
+	'''
+	values = np.asfortranarray(values, dtype=_npfloat)
+	if values.ndim != 2 or values.shape[0] < 1 or values.shape[1] < 1 or nstages < 1:
+		raise ValueError('values must be a W x M array and nstages at least 1')
+	result = np.zeros((values.shape[0], int(nstages)), dtype=_npfloat, order='F')
+	_lib.FORCESNLPsolver_resample_stages(values.ctypes.data, values.shape[1], result.ctypes.data, int(nstages), values.shape[0])
+	return result
+
+def FORCESNLPsolver_solve_coarse_to_fine(params_arg, coarse, packed=False, nthreads=0, timelimit=0, settings=None, interpolate=None):
+	'''
+   OUTPUT, EXITFLAG, INFO, COARSE_EXITFLAG = FORCESNLPsolver_py.FORCESNLPsolver_solve_coarse_to_fine(PARAMS, COARSE)
+   solves like FORCESNLPsolver_solve without warm start, but from the solution of the
+   problem decimated to the horizon of COARSE: the Python wrapper module of a solver
+   generated for fewer stages over the same time span, e.g. 16 stages for every 4th
+   of the 61. PARAMS['x0'] and PARAMS['all_parameters'] are resampled onto its stages
+   (see FORCESNLPsolver_resample_stages). INTERPOLATE (optional, 41 booleans) limits the
+   interpolation to the stage parameters that sample a signal over the horizon; the others
+   take the value of the fine stage nearest in time, and parameters of the stage grid
+   (stage length, stage time) must be set by COARSE itself. If its solve ends with
+   EXITFLAG 1, its solution resampled onto the 61 stages is the x0 of the full solve.
+   COARSE_EXITFLAG is the exitflag of the coarse solve. PACKED, NTHREADS, TIMELIMIT and
+   SETTINGS apply to the full solve as in FORCESNLPsolver_solve.
+	'''
+	dims = coarse.get_dims()
+	if dims['nstages'] < 2 or any(dims[name] != getattr(_dims, name) for name in ('nvar', 'npar', 'nxinit', 'nxfinal')):
+		raise ValueError('coarse solver must have the stage sizes of this one and at least 2 stages')
+	try:
+		x0 = np.reshape(np.require(params_arg['x0'], dtype=_npfloat), (_nvar, _nstages), order='F')
+		all_parameters = np.reshape(np.require(params_arg['all_parameters'], dtype=_npfloat), (_npar, _nstages), order='F')
+	except:
+		raise ValueError('Parameters x0 and all_parameters do not have the appropriate dimensions or data type. Please use numpy arrays for parameters.')
+
+	coarse_params = dict(params_arg)
+	coarse_params['x0'] = FORCESNLPsolver_resample_stages(x0, dims['nstages']).ravel(order='F')
+	coarse_all_parameters = FORCESNLPsolver_resample_stages(all_parameters, dims['nstages'])
+	if interpolate is not None:
+		held = ~np.asarray(interpolate, dtype=bool).ravel()
+		if held.size != _npar:
+			raise ValueError('interpolate must hold ' + str(_npar) + ' flags')
+		nearest = (np.arange(dims['nstages'])*(_nstages - 1) + (dims['nstages'] - 1)//2) // (dims['nstages'] - 1)
+		coarse_all_parameters[held, :] = all_parameters[held, :][:, nearest]
+	coarse_params['all_parameters'] = coarse_all_parameters.ravel(order='F')
+	coarse_output, coarse_exitflag, coarse_info = coarse.solve(coarse_params, packed=True)
 
-	return FORCESNLPsolver_outputs,int(exitflag),info_py
+	fine_params = dict(params_arg)
+	if coarse_exitflag == 1:
+		fine_params['x0'] = FORCESNLPsolver_resample_stages(coarse_output, _nstages).ravel(order='F')
+	outputs, exitflag, info = FORCESNLPsolver_solve(fine_params, 0, packed, nthreads, timelimit, settings)
+	return outputs, exitflag, info, coarse_exitflag
 
 solve = FORCESNLPsolver_solve
+solve_batch = FORCESNLPsolver_solve_batch
+solve_into = FORCESNLPsolver_solve_into
+solve_batch_template = FORCESNLPsolver_solve_batch_template
+set_param_slice = FORCESNLPsolver_set_param_slice
+set_stage_params = FORCESNLPsolver_set_stage_params
+set_profile = FORCESNLPsolver_set_profile
+get_profile = FORCESNLPsolver_get_profile
+set_trace = FORCESNLPsolver_set_trace
+get_trace = FORCESNLPsolver_get_trace
+read_records = FORCESNLPsolver_read_records
+sensitivity = FORCESNLPsolver_sensitivity
+set_cache = FORCESNLPsolver_set_cache
+submit = FORCESNLPsolver_submit
+get_cache_stats = FORCESNLPsolver_get_cache_stats
+get_dims = FORCESNLPsolver_get_dims
+resample_stages = FORCESNLPsolver_resample_stages
+solve_coarse_to_fine = FORCESNLPsolver_solve_coarse_to_fine
+get_metrics = FORCESNLPsolver_get_metrics
+metrics_text = FORCESNLPsolver_metrics_text
+reset_metrics = FORCESNLPsolver_reset_metrics
 
 
@@ -0,0 +1,289 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Zero-copy CPython extension for FORCESNLPsolver_py.py.
+
+Arguments are taken through the buffer protocol (NumPy arrays, array.array,
+memoryview, ...) and must be C-contiguous float64 (float32 for a solver built
+with FORCESNLPsolver_SINGLE_PRECISION; info is always float64), as in the
+ctypes fallback of FORCESNLPsolver_py.py. The solver reads the inputs
+and writes the 61x24 solution straight into the caller's output buffer, no
+Python objects are created per call. The module does not link against the
+solver: FORCESNLPsolver_py.py hands over the addresses of
+FORCESNLPsolver_solve_batch and FORCESNLPsolver_casadi2forces with bind().
+
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+#include "../include/FORCESNLPsolver_context.h"
+
+typedef solver_int32_default (*FORCESNLPsolver_batchfunc)(FORCESNLPsolver_params *, FORCESNLPsolver_output *, FORCESNLPsolver_info *, solver_int32_default *, solver_int32_default, solver_int32_default, FORCESNLPsolver_extfunc);
+
+/* entry points of the loaded solver library, set by bind() */
+static FORCESNLPsolver_batchfunc solve_batch = NULL;
+static FORCESNLPsolver_extfunc extfunc = NULL;
+
+/* buffer format of FORCESNLPsolver_float */
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+#define FORCESNLPsolver_PYEXT_FORMAT "f"
+#else
+#define FORCESNLPsolver_PYEXT_FORMAT "d"
+#endif
+
+/* info fields returned in the optional info buffer, same as the MEX INFO struct */
+#define FORCESNLPsolver_PYEXT_NINFO (10)
+
+
+/* BUFFER HELPERS -------------------------------------------------------*/
+/* gets a C-contiguous buffer of n elements of the struct module format (one of "d", "f"),
+   sets a Python error otherwise; Fortran order is refused, since out is filled and the
+   inputs are read in memory order */
+static int get_buffer(PyObject *obj, Py_ssize_t n, int writable, const char *format, Py_buffer *view, const char *name)
+{
+    Py_ssize_t itemsize = format[0] == 'f' ? 4 : 8;
+
+    int flags = PyBUF_FORMAT | PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0);
+
+    if( PyObject_GetBuffer(obj, view, flags) != 0 )
+    {
+        PyErr_Format(PyExc_ValueError, "%s must be a C-contiguous%s float%d buffer", name, writable ? " writable" : "", (int)(8 * itemsize));
+        return -1;
+    }
+    if( view->itemsize != itemsize || view->format == NULL || strcmp(view->format, format) != 0 || view->len != n * itemsize )
+    {
+        PyErr_Format(PyExc_ValueError, "%s must hold %zd float%d values", name, n, (int)(8 * itemsize));
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static void copy_info(double *dest, const FORCESNLPsolver_info *info)
+{
+    dest[0] = (double)info->it;
+    dest[1] = (double)info->it2opt;
+    dest[2] = info->res_eq;
+    dest[3] = info->res_ineq;
+    dest[4] = info->rsnorm;
+    dest[5] = info->rcompnorm;
+    dest[6] = info->pobj;
+    dest[7] = info->mu;
+    dest[8] = info->solvetime;
+    dest[9] = info->fevalstime;
+}
+
+/* solve with the GIL released; params and output may point into Python buffers */
+static solver_int32_default call_solver(FORCESNLPsolver_params *params, FORCESNLPsolver_output *output, FORCESNLPsolver_info *info)
+{
+    solver_int32_default exitflag;
+
+    Py_BEGIN_ALLOW_THREADS
+    solve_batch(params, output, info, &exitflag, 1, 1, extfunc);
+    Py_END_ALLOW_THREADS
+
+    return exitflag;
+}
+
+
+/* MODULE FUNCTIONS -----------------------------------------------------*/
+static PyObject *pyext_bind(PyObject *self, PyObject *args)
+{
+    unsigned long long batchaddr, extaddr;
+
+    (void) self;
+    if( !PyArg_ParseTuple(args, "KK", &batchaddr, &extaddr) )
+    {
+        return NULL;
+    }
+    if( batchaddr == 0 || extaddr == 0 )
+    {
+        PyErr_SetString(PyExc_ValueError, "bind() needs the addresses of FORCESNLPsolver_solve_batch and FORCESNLPsolver_casadi2forces");
+        return NULL;
+    }
+    solve_batch = (FORCESNLPsolver_batchfunc)(size_t)batchaddr;
+    extfunc = (FORCESNLPsolver_extfunc)(size_t)extaddr;
+    Py_RETURN_NONE;
+}
+
+static int check_bound(void)
+{
+    if( solve_batch == NULL )
+    {
+        PyErr_SetString(PyExc_RuntimeError, "FORCESNLPsolver_pyext is not bound to a solver library, import FORCESNLPsolver_py");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *pyext_solve(PyObject *self, PyObject *args)
+{
+    PyObject *ox0, *oxinit, *oxfinal, *oall, *oout, *oinfo = Py_None;
+    Py_buffer x0, xinit, xfinal, all_parameters, out, infobuf;
+    FORCESNLPsolver_params params;
+    FORCESNLPsolver_info info;
+    solver_int32_default exitflag;
+
+    (void) self;
+    if( check_bound() != 0 || !PyArg_ParseTuple(args, "OOOOO|O", &ox0, &oxinit, &oxfinal, &oall, &oout, &oinfo) )
+    {
+        return NULL;
+    }
+    if( get_buffer(ox0, 1464, 0, FORCESNLPsolver_PYEXT_FORMAT, &x0, "x0") != 0 )
+    {
+        return NULL;
+    }
+    if( get_buffer(oxinit, 16, 0, FORCESNLPsolver_PYEXT_FORMAT, &xinit, "xinit") != 0 )
+    {
+        goto fail_x0;
+    }
+    if( get_buffer(oxfinal, 11, 0, FORCESNLPsolver_PYEXT_FORMAT, &xfinal, "xfinal") != 0 )
+    {
+        goto fail_xinit;
+    }
+    if( get_buffer(oall, 2501, 0, FORCESNLPsolver_PYEXT_FORMAT, &all_parameters, "all_parameters") != 0 )
+    {
+        goto fail_xfinal;
+    }
+    if( get_buffer(oout, 1464, 1, FORCESNLPsolver_PYEXT_FORMAT, &out, "out") != 0 )
+    {
+        goto fail_all;
+    }
+    if( oinfo != Py_None && get_buffer(oinfo, FORCESNLPsolver_PYEXT_NINFO, 1, "d", &infobuf, "info") != 0 )
+    {
+        goto fail_out;
+    }
+
+    /* the solver expects the parameters in one struct */
+    memcpy(params.x0, x0.buf, sizeof(params.x0));
+    memcpy(params.xinit, xinit.buf, sizeof(params.xinit));
+    memcpy(params.xfinal, xfinal.buf, sizeof(params.xfinal));
+    memcpy(params.all_parameters, all_parameters.buf, sizeof(params.all_parameters));
+
+    /* the 61 stage vectors of FORCESNLPsolver_output are contiguous, out is used as is */
+    exitflag = call_solver(&params, (FORCESNLPsolver_output *) out.buf, &info);
+
+    if( oinfo != Py_None )
+    {
+        copy_info((double *) infobuf.buf, &info);
+        PyBuffer_Release(&infobuf);
+    }
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&all_parameters);
+    PyBuffer_Release(&xfinal);
+    PyBuffer_Release(&xinit);
+    PyBuffer_Release(&x0);
+    return PyLong_FromLong((long)exitflag);
+
+fail_out:
+    PyBuffer_Release(&out);
+fail_all:
+    PyBuffer_Release(&all_parameters);
+fail_xfinal:
+    PyBuffer_Release(&xfinal);
+fail_xinit:
+    PyBuffer_Release(&xinit);
+fail_x0:
+    PyBuffer_Release(&x0);
+    return NULL;
+}
+
+static PyObject *pyext_solve_packed(PyObject *self, PyObject *args)
+{
+    PyObject *oparams, *oout, *oinfo = Py_None;
+    Py_buffer params, out, infobuf;
+    FORCESNLPsolver_params copy, *solverparams;
+    FORCESNLPsolver_info info;
+    solver_int32_default exitflag;
+
+    (void) self;
+    if( check_bound() != 0 || !PyArg_ParseTuple(args, "OO|O", &oparams, &oout, &oinfo) )
+    {
+        return NULL;
+    }
+    if( get_buffer(oparams, sizeof(FORCESNLPsolver_params) / sizeof(FORCESNLPsolver_float), 0, FORCESNLPsolver_PYEXT_FORMAT, &params, "params") != 0 )
+    {
+        return NULL;
+    }
+    if( get_buffer(oout, 1464, 1, FORCESNLPsolver_PYEXT_FORMAT, &out, "out") != 0 )
+    {
+        PyBuffer_Release(&params);
+        return NULL;
+    }
+    if( oinfo != Py_None && get_buffer(oinfo, FORCESNLPsolver_PYEXT_NINFO, 1, "d", &infobuf, "info") != 0 )
+    {
+        PyBuffer_Release(&out);
+        PyBuffer_Release(&params);
+        return NULL;
+    }
+
+    /* params is laid out like FORCESNLPsolver_params and passed as is; the solver takes
+       it as writable, so a read-only buffer is copied */
+    if( params.readonly )
+    {
+        memcpy(&copy, params.buf, sizeof(FORCESNLPsolver_params));
+        solverparams = &copy;
+    }
+    else
+    {
+        solverparams = (FORCESNLPsolver_params *) params.buf;
+    }
+    exitflag = call_solver(solverparams, (FORCESNLPsolver_output *) out.buf, &info);
+
+    if( oinfo != Py_None )
+    {
+        copy_info((double *) infobuf.buf, &info);
+        PyBuffer_Release(&infobuf);
+    }
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&params);
+    return PyLong_FromLong((long)exitflag);
+}
+
+static PyMethodDef pyext_methods[] = {
+    {"bind", pyext_bind, METH_VARARGS,
+     "bind(solve_batch_address, casadi2forces_address) - set the solver entry points"},
+    {"solve", pyext_solve, METH_VARARGS,
+     "solve(x0, xinit, xfinal, all_parameters, out[, info]) -> exitflag\n\n"
+     "x0 (1464), xinit (16), xfinal (11), all_parameters (2501): inputs\n"
+     "out (61x24 = 1464): output, stage-major\n"
+     "all float64, float32 if float_size is 4\n"
+     "info (10, float64): it, it2opt, res_eq, res_ineq, rsnorm, rcompnorm, pobj, mu, solvetime, fevalstime"},
+    {"solve_packed", pyext_solve_packed, METH_VARARGS,
+     "solve_packed(params, out[, info]) -> exitflag\n\n"
+     "params (3992): x0, xinit, xfinal and all_parameters stacked, passed to the solver without copy\n"
+     "unless it is read-only"},
+    {NULL, NULL, 0, NULL}
+};
+
+
+/* MODULE DEFINITION ----------------------------------------------------*/
+#if PY_MAJOR_VERSION >= 3
+static struct PyModuleDef pyext_module = {
+    PyModuleDef_HEAD_INIT, "FORCESNLPsolver_pyext", "zero-copy interface to FORCESNLPsolver", -1, pyext_methods, NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit_FORCESNLPsolver_pyext(void)
+{
+    PyObject *m = PyModule_Create(&pyext_module);
+
+    /* must match FORCESNLPsolver_float_size() of the solver library */
+    if( m != NULL && PyModule_AddIntConstant(m, "float_size", (long) sizeof(FORCESNLPsolver_float)) != 0 )
+    {
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
+#else
+PyMODINIT_FUNC initFORCESNLPsolver_pyext(void)
+{
+    PyObject *m = Py_InitModule3("FORCESNLPsolver_pyext", pyext_methods, "zero-copy interface to FORCESNLPsolver");
+
+    if( m != NULL )
+    {
+        PyModule_AddIntConstant(m, "float_size", (long) sizeof(FORCESNLPsolver_float));
+    }
+}
+#endif
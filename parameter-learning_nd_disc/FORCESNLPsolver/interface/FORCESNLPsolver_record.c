@@ -0,0 +1,290 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Binary files of recorded solves, see ../include/FORCESNLPsolver_record.h
+
+*/
+
+/* fstat, mmap */
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/FORCESNLPsolver_record.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* stdio buffer of a writer, records go to the file in large chunks */
+#define FORCESNLPsolver_RECORD_BUFFER (1 << 20)
+
+
+/* HEADER ---------------------------------------------------------------*/
+static void FORCESNLPsolver_record_make_header(FORCESNLPsolver_record_header *header)
+{
+    memset(header, 0, sizeof(FORCESNLPsolver_record_header));
+    strcpy(header->magic, FORCESNLPsolver_RECORD_MAGIC);
+    header->version = FORCESNLPsolver_RECORD_VERSION;
+    header->byteorder = FORCESNLPsolver_RECORD_BYTEORDER;
+    header->header_size = (solver_int32_unsigned) sizeof(FORCESNLPsolver_record_header);
+    header->record_size = (solver_int32_unsigned) sizeof(FORCESNLPsolver_record);
+    header->n_x0 = 1464;
+    header->n_xinit = 16;
+    header->n_xfinal = 11;
+    header->n_all_parameters = 2501;
+    header->n_output = 1464;
+    header->n_info = FORCESNLPsolver_RECORD_NINFO;
+}
+
+/* nonzero if header describes records of this layout */
+static int FORCESNLPsolver_record_header_ok(const FORCESNLPsolver_record_header *header)
+{
+    FORCESNLPsolver_record_header expected;
+
+    FORCESNLPsolver_record_make_header(&expected);
+    return memcmp(header, &expected, sizeof(FORCESNLPsolver_record_header)) == 0;
+}
+
+
+/* WRITING --------------------------------------------------------------*/
+struct FORCESNLPsolver_record_writer
+{
+    FILE *fs;
+    char *buffer;
+    solver_int32_default failed;
+
+    /* staging of the record being appended */
+    FORCESNLPsolver_record record;
+};
+
+FORCESNLPsolver_record_writer *FORCESNLPsolver_record_open(const char *path)
+{
+    FORCESNLPsolver_record_header header;
+    FORCESNLPsolver_record_writer *writer;
+    FILE *fs;
+    long size = 0;
+
+    /* an existing file must have a matching header and end on a record boundary */
+    fs = fopen(path, "rb");
+    if( fs != NULL )
+    {
+        if( fseek(fs, 0, SEEK_END) == 0 )
+        {
+            size = ftell(fs);
+        }
+        rewind(fs);
+        if( size > 0 && (fread(&header, sizeof(header), 1, fs) != 1 || !FORCESNLPsolver_record_header_ok(&header)
+                         || (size - (long) sizeof(header)) % (long) sizeof(FORCESNLPsolver_record) != 0) )
+        {
+            fclose(fs);
+            return NULL;
+        }
+        fclose(fs);
+    }
+
+    writer = (FORCESNLPsolver_record_writer *) malloc(sizeof(FORCESNLPsolver_record_writer));
+    if( writer == NULL )
+    {
+        return NULL;
+    }
+    writer->fs = fopen(path, "ab");
+    if( writer->fs == NULL )
+    {
+        free(writer);
+        return NULL;
+    }
+    writer->buffer = (char *) malloc(FORCESNLPsolver_RECORD_BUFFER);
+    if( writer->buffer != NULL )
+    {
+        setvbuf(writer->fs, writer->buffer, _IOFBF, FORCESNLPsolver_RECORD_BUFFER);
+    }
+    writer->failed = 0;
+    if( size == 0 )
+    {
+        FORCESNLPsolver_record_make_header(&header);
+        if( fwrite(&header, sizeof(header), 1, writer->fs) != 1 )
+        {
+            writer->failed = 1;
+        }
+    }
+    return writer;
+}
+
+void FORCESNLPsolver_record_fill(FORCESNLPsolver_record *rec, const FORCESNLPsolver_params *params, const FORCESNLPsolver_output *output, const FORCESNLPsolver_info *info, solver_int32_default exitflag)
+{
+    double *dest = (double *) rec;
+    const FORCESNLPsolver_float *src;
+    solver_int32_default i;
+
+    /* the parameter and output vectors are contiguous, in both structs */
+    src = (const FORCESNLPsolver_float *) params;
+    for( i = 0; i < 3992; i++ )
+    {
+        dest[i] = (double) src[i];
+    }
+    src = (const FORCESNLPsolver_float *) output;
+    for( i = 0; i < 1464; i++ )
+    {
+        rec->output[i] = output != NULL ? (double) src[i] : 0.0;
+    }
+    memset(rec->info, 0, sizeof(rec->info));
+    if( info != NULL )
+    {
+        rec->info[0] = (double) info->it;
+        rec->info[1] = (double) info->it2opt;
+        rec->info[2] = info->res_eq;
+        rec->info[3] = info->res_ineq;
+        rec->info[4] = info->rsnorm;
+        rec->info[5] = info->rcompnorm;
+        rec->info[6] = info->pobj;
+        rec->info[7] = info->dobj;
+        rec->info[8] = info->dgap;
+        rec->info[9] = info->rdgap;
+        rec->info[10] = info->mu;
+        rec->info[11] = info->mu_aff;
+        rec->info[12] = info->sigma;
+        rec->info[13] = (double) info->lsit_aff;
+        rec->info[14] = (double) info->lsit_cc;
+        rec->info[15] = info->step_aff;
+        rec->info[16] = info->step_cc;
+        rec->info[17] = info->solvetime;
+        rec->info[18] = info->fevalstime;
+    }
+    rec->exitflag = (double) exitflag;
+}
+
+solver_int32_default FORCESNLPsolver_record_write(FORCESNLPsolver_record_writer *writer, const FORCESNLPsolver_record *record)
+{
+    if( fwrite(record, sizeof(FORCESNLPsolver_record), 1, writer->fs) != 1 )
+    {
+        writer->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+solver_int32_default FORCESNLPsolver_record_append(FORCESNLPsolver_record_writer *writer, const FORCESNLPsolver_params *params, const FORCESNLPsolver_output *output, const FORCESNLPsolver_info *info, solver_int32_default exitflag)
+{
+    FORCESNLPsolver_record_fill(&writer->record, params, output, info, exitflag);
+    return FORCESNLPsolver_record_write(writer, &writer->record);
+}
+
+solver_int32_default FORCESNLPsolver_record_close(FORCESNLPsolver_record_writer *writer)
+{
+    solver_int32_default failed = writer->failed;
+
+    if( fclose(writer->fs) != 0 )
+    {
+        failed = 1;
+    }
+    free(writer->buffer);
+    free(writer);
+    return failed ? -1 : 0;
+}
+
+void FORCESNLPsolver_record_params(const FORCESNLPsolver_record *record, FORCESNLPsolver_params *params)
+{
+    FORCESNLPsolver_float *dest = (FORCESNLPsolver_float *) params;
+    const double *src = (const double *) record;
+    solver_int32_default i;
+
+    for( i = 0; i < 3992; i++ )
+    {
+        dest[i] = (FORCESNLPsolver_float) src[i];
+    }
+}
+
+
+/* MAPPING --------------------------------------------------------------*/
+solver_int32_default FORCESNLPsolver_record_map(const char *path, FORCESNLPsolver_record_file *file)
+{
+    const FORCESNLPsolver_record_header *header;
+#if defined(_WIN32)
+    HANDLE fh, mh;
+    LARGE_INTEGER size;
+#else
+    struct stat st;
+    int fd;
+#endif
+
+    memset(file, 0, sizeof(FORCESNLPsolver_record_file));
+#if defined(_WIN32)
+    fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if( fh == INVALID_HANDLE_VALUE )
+    {
+        return -1;
+    }
+    if( !GetFileSizeEx(fh, &size) || size.QuadPart < (LONGLONG) sizeof(FORCESNLPsolver_record_header) )
+    {
+        CloseHandle(fh);
+        return -1;
+    }
+    mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh);
+    if( mh == NULL )
+    {
+        return -1;
+    }
+    file->base = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    if( file->base == NULL )
+    {
+        CloseHandle(mh);
+        return -1;
+    }
+    file->handle = mh;
+    file->size = (size_t) size.QuadPart;
+#else
+    fd = open(path, O_RDONLY);
+    if( fd < 0 )
+    {
+        return -1;
+    }
+    if( fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(FORCESNLPsolver_record_header) )
+    {
+        close(fd);
+        return -1;
+    }
+    file->base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if( file->base == MAP_FAILED )
+    {
+        file->base = NULL;
+        return -1;
+    }
+    file->size = (size_t) st.st_size;
+#endif
+
+    header = (const FORCESNLPsolver_record_header *) file->base;
+    if( !FORCESNLPsolver_record_header_ok(header) )
+    {
+        FORCESNLPsolver_record_unmap(file);
+        return -1;
+    }
+    /* a partial record at the end (interrupted writer) is ignored */
+    file->records = (const FORCESNLPsolver_record *) ((const char *) file->base + header->header_size);
+    file->count = (solver_int64_default) ((file->size - header->header_size) / sizeof(FORCESNLPsolver_record));
+    return 0;
+}
+
+void FORCESNLPsolver_record_unmap(FORCESNLPsolver_record_file *file)
+{
+    if( file->base != NULL )
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(file->base);
+        CloseHandle((HANDLE) file->handle);
+#else
+        munmap(file->base, file->size);
+#endif
+    }
+    memset(file, 0, sizeof(FORCESNLPsolver_record_file));
+}
@@ -35,6 +35,7 @@ jurisdiction in case of any dispute.
 
 /* include FORCES functions and defs */
 #include "../include/FORCESNLPsolver.h" 
+#include "../include/FORCESNLPsolver_context.h"
 
 #if defined(MATLAB_MEX_FILE)
 #include "tmwtypes.h"
@@ -45,8 +46,15 @@ jurisdiction in case of any dispute.
 
 typedef FORCESNLPsolverinterface_float FORCESNLPsolvernmpc_float;
 
-extern void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f, double *c, double *nabla_c, double *h, double *nabla_h, double *hess, solver_int32_default stage);
+extern void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
 FORCESNLPsolver_extfunc pt2function = &FORCESNLPsolver_casadi2forces;
+
+/* solver printout goes to the Simulink diagnostics */
+static void printLog(void *userdata, const char *text, size_t len)
+{
+	(void) userdata;
+	ssPrintf("%.*s", (int)len, text);
+}
 
 
 
@@ -63,11 +71,17 @@ static void mdlInitializeSizes(SimStruct *S)
 
     DECL_AND_INIT_DIMSINFO(inputDimsInfo);
     DECL_AND_INIT_DIMSINFO(outputDimsInfo);
-    ssSetNumSFcnParams(S, 0);
+    /* one optional parameter, the warm start mode (see mdlStart); blocks
+       without it solve from their x0 input */
+    ssSetNumSFcnParams(S, ssGetSFcnParamsCount(S) > 0 ? 1 : 0);
     if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) 
 	{
 		return; /* Parameter mismatch will be reported by Simulink */
     }
+    if (ssGetNumSFcnParams(S) > 0)
+	{
+		ssSetSFcnParamTunable(S, 0, SS_PRM_NOT_TUNABLE);
+    }
 
 	/* initialize size of continuous and discrete states to zero */
     ssSetNumContStates(S, 0);
@@ -417,7 +431,7 @@ static void mdlInitializeSizes(SimStruct *S)
 	/* set internal memory of block */
     ssSetNumRWork(S, 0);
     ssSetNumIWork(S, 0);
-    ssSetNumPWork(S, 0);
+    ssSetNumPWork(S, 1); /* solver context, see mdlStart */
     ssSetNumModes(S, 0);
     ssSetNumNonsampledZCs(S, 0);
 
@@ -489,6 +503,42 @@ static void mdlSetDefaultPortDataTypes(SimStruct *S)
 
 
 
+#define MDL_START
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Allocates the solver context once per simulation, kept in PWork. With
+ *    the warm start parameter set to 1 (reuse) or 2 (shift by one stage, for
+ *    receding horizon MPC), each sample starts from the last optimal solution
+ *    of the block instead of its x0 input (see FORCESNLPsolver_WARMSTART_*).
+ */
+static void mdlStart(SimStruct *S)
+{
+	FORCESNLPsolver_context *ctx;
+	real_T warmstart = 0;
+
+	if( ssGetSFcnParamsCount(S) > 0 && mxGetNumberOfElements(ssGetSFcnParam(S, 0)) > 0 )
+	{
+		warmstart = mxGetPr(ssGetSFcnParam(S, 0))[0];
+	}
+	if( warmstart != FORCESNLPsolver_WARMSTART_OFF && warmstart != FORCESNLPsolver_WARMSTART_REUSE && warmstart != FORCESNLPsolver_WARMSTART_SHIFT )
+	{
+		ssSetErrorStatus(S, "FORCESNLPsolver: warm start parameter must be 0, 1 or 2");
+		return;
+	}
+
+	ctx = FORCESNLPsolver_create(pt2function);
+	if( ctx == NULL )
+	{
+		ssSetErrorStatus(S, "FORCESNLPsolver: out of memory");
+		return;
+	}
+    #if FORCESNLPsolver_SET_PRINTLEVEL > 0
+	FORCESNLPsolver_set_log(ctx, printLog, NULL);
+	#endif
+	ctx->warmstart = (solver_int32_default) warmstart;
+	ssGetPWork(S)[0] = ctx;
+}
+
 /* Function: mdlOutputs =======================================================
  *
 */
@@ -496,9 +546,6 @@ static void mdlOutputs(SimStruct *S, int_T tid)
 {
 	solver_int32_default i, j, k;
 	
-	/* file pointer for printing */
-	FILE *fp = NULL;
-
 	/* Simulink data */
 	const real_T *x0 = (const real_T*) ssGetInputPortSignal(S,0);
 	const real_T *xinit = (const real_T*) ssGetInputPortSignal(S,1);
@@ -570,368 +617,349 @@ static void mdlOutputs(SimStruct *S, int_T tid)
 	
 
 	/* Solver data */
-	FORCESNLPsolver_params params;
-	FORCESNLPsolver_output output;
-	FORCESNLPsolver_info info;	
+	FORCESNLPsolver_context *ctx = (FORCESNLPsolver_context *) ssGetPWork(S)[0];
 	solver_int32_default exitflag;
 
 	/* Extra NMPC data */
 	
 
-	/* Copy inputs */
-	for( i=0; i<1464; i++)
-	{ 
-		params.x0[i] = (double) x0[i]; 
+	/* Copy inputs; the stored solution, if any, replaces the x0 input */
+	if( !ctx->warm_valid || ctx->warmstart == FORCESNLPsolver_WARMSTART_OFF )
+	{
+		for( i=0; i<1464; i++)
+		{ 
+			ctx->params.x0[i] = (FORCESNLPsolver_float) x0[i]; 
+		}
 	}
 
 	for( i=0; i<16; i++)
 	{ 
-		params.xinit[i] = (double) xinit[i]; 
+		ctx->params.xinit[i] = (FORCESNLPsolver_float) xinit[i]; 
 	}
 
 	for( i=0; i<11; i++)
 	{ 
-		params.xfinal[i] = (double) xfinal[i]; 
+		ctx->params.xfinal[i] = (FORCESNLPsolver_float) xfinal[i]; 
 	}
 
 	for( i=0; i<2501; i++)
 	{ 
-		params.all_parameters[i] = (double) all_parameters[i]; 
+		ctx->params.all_parameters[i] = (FORCESNLPsolver_float) all_parameters[i]; 
 	}
 
 	
 
 	
 
-    #if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Prepare file for printfs */
-        fp = fopen("stdout_temp","w+");
-		if( fp == NULL ) 
-		{
-			mexErrMsgTxt("freopen of stdout did not work.");
-		}
-		rewind(fp);
-	#endif
-
-	/* Call solver */
-	exitflag = FORCESNLPsolver_solve(&params, &output, &info, fp , pt2function);
-
-	#if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Read contents of printfs printed to file */
-		rewind(fp);
-		while( (i = fgetc(fp)) != EOF ) 
-		{
-			ssPrintf("%c",i);
-		}
-		fclose(fp);
-	#endif
+	/* Call solver, printout is forwarded by printLog */
+	exitflag = FORCESNLPsolver_solve_ctx(ctx);
 
 	
 
 	/* Copy outputs */
 	for( i=0; i<24; i++)
 	{ 
-		x01[i] = (real_T) output.x01[i]; 
+		x01[i] = (real_T) ctx->output.x01[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x02[i] = (real_T) output.x02[i]; 
+		x02[i] = (real_T) ctx->output.x02[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x03[i] = (real_T) output.x03[i]; 
+		x03[i] = (real_T) ctx->output.x03[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x04[i] = (real_T) output.x04[i]; 
+		x04[i] = (real_T) ctx->output.x04[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x05[i] = (real_T) output.x05[i]; 
+		x05[i] = (real_T) ctx->output.x05[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x06[i] = (real_T) output.x06[i]; 
+		x06[i] = (real_T) ctx->output.x06[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x07[i] = (real_T) output.x07[i]; 
+		x07[i] = (real_T) ctx->output.x07[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x08[i] = (real_T) output.x08[i]; 
+		x08[i] = (real_T) ctx->output.x08[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x09[i] = (real_T) output.x09[i]; 
+		x09[i] = (real_T) ctx->output.x09[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x10[i] = (real_T) output.x10[i]; 
+		x10[i] = (real_T) ctx->output.x10[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x11[i] = (real_T) output.x11[i]; 
+		x11[i] = (real_T) ctx->output.x11[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x12[i] = (real_T) output.x12[i]; 
+		x12[i] = (real_T) ctx->output.x12[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x13[i] = (real_T) output.x13[i]; 
+		x13[i] = (real_T) ctx->output.x13[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x14[i] = (real_T) output.x14[i]; 
+		x14[i] = (real_T) ctx->output.x14[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x15[i] = (real_T) output.x15[i]; 
+		x15[i] = (real_T) ctx->output.x15[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x16[i] = (real_T) output.x16[i]; 
+		x16[i] = (real_T) ctx->output.x16[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x17[i] = (real_T) output.x17[i]; 
+		x17[i] = (real_T) ctx->output.x17[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x18[i] = (real_T) output.x18[i]; 
+		x18[i] = (real_T) ctx->output.x18[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x19[i] = (real_T) output.x19[i]; 
+		x19[i] = (real_T) ctx->output.x19[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x20[i] = (real_T) output.x20[i]; 
+		x20[i] = (real_T) ctx->output.x20[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x21[i] = (real_T) output.x21[i]; 
+		x21[i] = (real_T) ctx->output.x21[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x22[i] = (real_T) output.x22[i]; 
+		x22[i] = (real_T) ctx->output.x22[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x23[i] = (real_T) output.x23[i]; 
+		x23[i] = (real_T) ctx->output.x23[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x24[i] = (real_T) output.x24[i]; 
+		x24[i] = (real_T) ctx->output.x24[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x25[i] = (real_T) output.x25[i]; 
+		x25[i] = (real_T) ctx->output.x25[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x26[i] = (real_T) output.x26[i]; 
+		x26[i] = (real_T) ctx->output.x26[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x27[i] = (real_T) output.x27[i]; 
+		x27[i] = (real_T) ctx->output.x27[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x28[i] = (real_T) output.x28[i]; 
+		x28[i] = (real_T) ctx->output.x28[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x29[i] = (real_T) output.x29[i]; 
+		x29[i] = (real_T) ctx->output.x29[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x30[i] = (real_T) output.x30[i]; 
+		x30[i] = (real_T) ctx->output.x30[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x31[i] = (real_T) output.x31[i]; 
+		x31[i] = (real_T) ctx->output.x31[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x32[i] = (real_T) output.x32[i]; 
+		x32[i] = (real_T) ctx->output.x32[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x33[i] = (real_T) output.x33[i]; 
+		x33[i] = (real_T) ctx->output.x33[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x34[i] = (real_T) output.x34[i]; 
+		x34[i] = (real_T) ctx->output.x34[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x35[i] = (real_T) output.x35[i]; 
+		x35[i] = (real_T) ctx->output.x35[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x36[i] = (real_T) output.x36[i]; 
+		x36[i] = (real_T) ctx->output.x36[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x37[i] = (real_T) output.x37[i]; 
+		x37[i] = (real_T) ctx->output.x37[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x38[i] = (real_T) output.x38[i]; 
+		x38[i] = (real_T) ctx->output.x38[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x39[i] = (real_T) output.x39[i]; 
+		x39[i] = (real_T) ctx->output.x39[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x40[i] = (real_T) output.x40[i]; 
+		x40[i] = (real_T) ctx->output.x40[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x41[i] = (real_T) output.x41[i]; 
+		x41[i] = (real_T) ctx->output.x41[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x42[i] = (real_T) output.x42[i]; 
+		x42[i] = (real_T) ctx->output.x42[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x43[i] = (real_T) output.x43[i]; 
+		x43[i] = (real_T) ctx->output.x43[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x44[i] = (real_T) output.x44[i]; 
+		x44[i] = (real_T) ctx->output.x44[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x45[i] = (real_T) output.x45[i]; 
+		x45[i] = (real_T) ctx->output.x45[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x46[i] = (real_T) output.x46[i]; 
+		x46[i] = (real_T) ctx->output.x46[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x47[i] = (real_T) output.x47[i]; 
+		x47[i] = (real_T) ctx->output.x47[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x48[i] = (real_T) output.x48[i]; 
+		x48[i] = (real_T) ctx->output.x48[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x49[i] = (real_T) output.x49[i]; 
+		x49[i] = (real_T) ctx->output.x49[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x50[i] = (real_T) output.x50[i]; 
+		x50[i] = (real_T) ctx->output.x50[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x51[i] = (real_T) output.x51[i]; 
+		x51[i] = (real_T) ctx->output.x51[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x52[i] = (real_T) output.x52[i]; 
+		x52[i] = (real_T) ctx->output.x52[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x53[i] = (real_T) output.x53[i]; 
+		x53[i] = (real_T) ctx->output.x53[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x54[i] = (real_T) output.x54[i]; 
+		x54[i] = (real_T) ctx->output.x54[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x55[i] = (real_T) output.x55[i]; 
+		x55[i] = (real_T) ctx->output.x55[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x56[i] = (real_T) output.x56[i]; 
+		x56[i] = (real_T) ctx->output.x56[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x57[i] = (real_T) output.x57[i]; 
+		x57[i] = (real_T) ctx->output.x57[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x58[i] = (real_T) output.x58[i]; 
+		x58[i] = (real_T) ctx->output.x58[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x59[i] = (real_T) output.x59[i]; 
+		x59[i] = (real_T) ctx->output.x59[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x60[i] = (real_T) output.x60[i]; 
+		x60[i] = (real_T) ctx->output.x60[i]; 
 	}
 
 	for( i=0; i<24; i++)
 	{ 
-		x61[i] = (real_T) output.x61[i]; 
+		x61[i] = (real_T) ctx->output.x61[i]; 
 	}
 
 	
@@ -949,6 +977,8 @@ static void mdlOutputs(SimStruct *S, int_T tid)
  */
 static void mdlTerminate(SimStruct *S)
 {
+	FORCESNLPsolver_destroy((FORCESNLPsolver_context *) ssGetPWork(S)[0]);
+	ssGetPWork(S)[0] = NULL;
 }
 #ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
 #include "simulink.c"      /* MEX-file interface mechanism */
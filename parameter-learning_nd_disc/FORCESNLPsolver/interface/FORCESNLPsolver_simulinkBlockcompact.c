@@ -27,6 +27,7 @@ jurisdiction in case of any dispute.
 #define S_FUNCTION_NAME FORCESNLPsolver_simulinkBlockcompact
 
 #include "simstruc.h"
+#include <string.h>
 
 
 
@@ -35,6 +36,7 @@ jurisdiction in case of any dispute.
 
 /* include FORCES functions and defs */
 #include "../include/FORCESNLPsolver.h" 
+#include "../include/FORCESNLPsolver_context.h"
 
 #if defined(MATLAB_MEX_FILE)
 #include "tmwtypes.h"
@@ -45,8 +47,15 @@ jurisdiction in case of any dispute.
 
 typedef FORCESNLPsolverinterface_float FORCESNLPsolvernmpc_float;
 
-extern void FORCESNLPsolver_casadi2forces(double *x, double *y, double *l, double *p, double *f, double *nabla_f, double *c, double *nabla_c, double *h, double *nabla_h, double *hess, solver_int32_default stage);
+extern void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
 FORCESNLPsolver_extfunc pt2function = &FORCESNLPsolver_casadi2forces;
+
+/* solver printout goes to the Simulink diagnostics */
+static void printLog(void *userdata, const char *text, size_t len)
+{
+	(void) userdata;
+	ssPrintf("%.*s", (int)len, text);
+}
 
 
 
@@ -63,11 +72,17 @@ static void mdlInitializeSizes(SimStruct *S)
 
     DECL_AND_INIT_DIMSINFO(inputDimsInfo);
     DECL_AND_INIT_DIMSINFO(outputDimsInfo);
-    ssSetNumSFcnParams(S, 0);
+    /* one optional parameter, the warm start mode (see mdlStart); blocks
+       without it solve from their x0 input */
+    ssSetNumSFcnParams(S, ssGetSFcnParamsCount(S) > 0 ? 1 : 0);
     if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) 
 	{
 		return; /* Parameter mismatch will be reported by Simulink */
     }
+    if (ssGetNumSFcnParams(S) > 0)
+	{
+		ssSetSFcnParamTunable(S, 0, SS_PRM_NOT_TUNABLE);
+    }
 
 	/* initialize size of continuous and discrete states to zero */
     ssSetNumContStates(S, 0);
@@ -117,7 +132,7 @@ static void mdlInitializeSizes(SimStruct *S)
 	/* set internal memory of block */
     ssSetNumRWork(S, 0);
     ssSetNumIWork(S, 0);
-    ssSetNumPWork(S, 0);
+    ssSetNumPWork(S, 1); /* solver context, see mdlStart */
     ssSetNumModes(S, 0);
     ssSetNumNonsampledZCs(S, 0);
 
@@ -189,16 +204,52 @@ static void mdlSetDefaultPortDataTypes(SimStruct *S)
 
 
 
+#define MDL_START
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Allocates the solver context once per simulation, kept in PWork. With
+ *    the warm start parameter set to 1 (reuse) or 2 (shift by one stage, for
+ *    receding horizon MPC), each sample starts from the last optimal solution
+ *    of the block instead of its x0 input (see FORCESNLPsolver_WARMSTART_*).
+ */
+static void mdlStart(SimStruct *S)
+{
+	FORCESNLPsolver_context *ctx;
+	real_T warmstart = 0;
+
+	if( ssGetSFcnParamsCount(S) > 0 && mxGetNumberOfElements(ssGetSFcnParam(S, 0)) > 0 )
+	{
+		warmstart = mxGetPr(ssGetSFcnParam(S, 0))[0];
+	}
+	if( warmstart != FORCESNLPsolver_WARMSTART_OFF && warmstart != FORCESNLPsolver_WARMSTART_REUSE && warmstart != FORCESNLPsolver_WARMSTART_SHIFT )
+	{
+		ssSetErrorStatus(S, "FORCESNLPsolver: warm start parameter must be 0, 1 or 2");
+		return;
+	}
+
+	ctx = FORCESNLPsolver_create(pt2function);
+	if( ctx == NULL )
+	{
+		ssSetErrorStatus(S, "FORCESNLPsolver: out of memory");
+		return;
+	}
+    #if FORCESNLPsolver_SET_PRINTLEVEL > 0
+	FORCESNLPsolver_set_log(ctx, printLog, NULL);
+	#endif
+	ctx->warmstart = (solver_int32_default) warmstart;
+	ssGetPWork(S)[0] = ctx;
+}
+
 /* Function: mdlOutputs =======================================================
  *
 */
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
-	solver_int32_default i, j, k;
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+	solver_int32_default i;
+	const FORCESNLPsolver_float *stages;
+#endif
 	
-	/* file pointer for printing */
-	FILE *fp = NULL;
-
 	/* Simulink data */
 	const real_T *x0 = (const real_T*) ssGetInputPortSignal(S,0);
 	const real_T *xinit = (const real_T*) ssGetInputPortSignal(S,1);
@@ -210,431 +261,57 @@ static void mdlOutputs(SimStruct *S, int_T tid)
 	
 
 	/* Solver data */
-	FORCESNLPsolver_params params;
-	FORCESNLPsolver_output output;
-	FORCESNLPsolver_info info;	
+	FORCESNLPsolver_context *ctx = (FORCESNLPsolver_context *) ssGetPWork(S)[0];
 	solver_int32_default exitflag;
 
 	/* Extra NMPC data */
 	
 
-	/* Copy inputs */
-	for( i=0; i<1464; i++)
-	{ 
-		params.x0[i] = (double) x0[i]; 
+	/* Copy inputs; the stored solution, if any, replaces the x0 input */
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+	if( !ctx->warm_valid || ctx->warmstart == FORCESNLPsolver_WARMSTART_OFF )
+	{
+		for( i=0; i<1464; i++)
+		{ 
+			ctx->params.x0[i] = (FORCESNLPsolver_float) x0[i]; 
+		}
 	}
-
 	for( i=0; i<16; i++)
 	{ 
-		params.xinit[i] = (double) xinit[i]; 
+		ctx->params.xinit[i] = (FORCESNLPsolver_float) xinit[i]; 
 	}
-
 	for( i=0; i<11; i++)
 	{ 
-		params.xfinal[i] = (double) xfinal[i]; 
+		ctx->params.xfinal[i] = (FORCESNLPsolver_float) xfinal[i]; 
 	}
-
 	for( i=0; i<2501; i++)
 	{ 
-		params.all_parameters[i] = (double) all_parameters[i]; 
-	}
-
-	
-
-	
-
-    #if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Prepare file for printfs */
-        fp = fopen("stdout_temp","w+");
-		if( fp == NULL ) 
-		{
-			mexErrMsgTxt("freopen of stdout did not work.");
-		}
-		rewind(fp);
-	#endif
-
-	/* Call solver */
-	exitflag = FORCESNLPsolver_solve(&params, &output, &info, fp , pt2function);
-
-	#if FORCESNLPsolver_SET_PRINTLEVEL > 0
-		/* Read contents of printfs printed to file */
-		rewind(fp);
-		while( (i = fgetc(fp)) != EOF ) 
-		{
-			ssPrintf("%c",i);
-		}
-		fclose(fp);
-	#endif
-
-	
-
-	/* Copy outputs */
-	for( i=0; i<24; i++)
-	{ 
-		outputs[i] = (real_T) output.x01[i]; 
-	}
-
-	k=24; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x02[i]; 
-	}
-
-	k=48; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x03[i]; 
-	}
-
-	k=72; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x04[i]; 
-	}
-
-	k=96; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x05[i]; 
-	}
-
-	k=120; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x06[i]; 
-	}
-
-	k=144; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x07[i]; 
-	}
-
-	k=168; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x08[i]; 
-	}
-
-	k=192; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x09[i]; 
-	}
-
-	k=216; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x10[i]; 
-	}
-
-	k=240; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x11[i]; 
-	}
-
-	k=264; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x12[i]; 
-	}
-
-	k=288; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x13[i]; 
-	}
-
-	k=312; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x14[i]; 
-	}
-
-	k=336; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x15[i]; 
-	}
-
-	k=360; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x16[i]; 
-	}
-
-	k=384; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x17[i]; 
-	}
-
-	k=408; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x18[i]; 
-	}
-
-	k=432; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x19[i]; 
-	}
-
-	k=456; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x20[i]; 
-	}
-
-	k=480; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x21[i]; 
-	}
-
-	k=504; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x22[i]; 
-	}
-
-	k=528; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x23[i]; 
-	}
-
-	k=552; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x24[i]; 
-	}
-
-	k=576; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x25[i]; 
-	}
-
-	k=600; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x26[i]; 
-	}
-
-	k=624; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x27[i]; 
-	}
-
-	k=648; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x28[i]; 
-	}
-
-	k=672; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x29[i]; 
-	}
-
-	k=696; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x30[i]; 
-	}
-
-	k=720; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x31[i]; 
-	}
-
-	k=744; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x32[i]; 
-	}
-
-	k=768; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x33[i]; 
-	}
-
-	k=792; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x34[i]; 
-	}
-
-	k=816; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x35[i]; 
-	}
-
-	k=840; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x36[i]; 
+		ctx->params.all_parameters[i] = (FORCESNLPsolver_float) all_parameters[i]; 
 	}
-
-	k=864; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x37[i]; 
+#else
+	/* the contiguous port signals are copied as blocks, x0 only if it is used */
+	if( !ctx->warm_valid || ctx->warmstart == FORCESNLPsolver_WARMSTART_OFF )
+	{
+		memcpy(ctx->params.x0, x0, 1464 * sizeof(real_T));
 	}
+	memcpy(ctx->params.xinit, xinit, 16 * sizeof(real_T));
+	memcpy(ctx->params.xfinal, xfinal, 11 * sizeof(real_T));
+	memcpy(ctx->params.all_parameters, all_parameters, 2501 * sizeof(real_T));
+#endif
 
-	k=888; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x38[i]; 
-	}
-
-	k=912; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x39[i]; 
-	}
+	/* Call solver, printout is forwarded by printLog */
+	exitflag = FORCESNLPsolver_solve_ctx(ctx);
 
-	k=936; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x40[i]; 
-	}
-
-	k=960; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x41[i]; 
-	}
-
-	k=984; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x42[i]; 
-	}
-
-	k=1008; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x43[i]; 
-	}
-
-	k=1032; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x44[i]; 
-	}
-
-	k=1056; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x45[i]; 
-	}
-
-	k=1080; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x46[i]; 
-	}
-
-	k=1104; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x47[i]; 
-	}
-
-	k=1128; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x48[i]; 
-	}
-
-	k=1152; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x49[i]; 
-	}
-
-	k=1176; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x50[i]; 
-	}
-
-	k=1200; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x51[i]; 
-	}
-
-	k=1224; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x52[i]; 
-	}
-
-	k=1248; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x53[i]; 
-	}
-
-	k=1272; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x54[i]; 
-	}
-
-	k=1296; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x55[i]; 
-	}
-
-	k=1320; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x56[i]; 
-	}
-
-	k=1344; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x57[i]; 
-	}
-
-	k=1368; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x58[i]; 
-	}
-
-	k=1392; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x59[i]; 
-	}
-
-	k=1416; 
-	for( i=0; i<24; i++)
-	{ 
-		outputs[k++] = (real_T) output.x60[i]; 
-	}
-
-	k=1440; 
-	for( i=0; i<24; i++)
+	/* Copy outputs, the 61 stages of FORCESNLPsolver_output are stacked like the output port */
+#ifdef FORCESNLPsolver_SINGLE_PRECISION
+	stages = (const FORCESNLPsolver_float *) &ctx->output;
+	for( i=0; i<1464; i++)
 	{ 
-		outputs[k++] = (real_T) output.x61[i]; 
+		outputs[i] = (real_T) stages[i]; 
 	}
-
-	
+#else
+	memcpy(outputs, &ctx->output, 1464 * sizeof(real_T));
+#endif
 }
 
 
@@ -649,6 +326,8 @@ static void mdlOutputs(SimStruct *S, int_T tid)
  */
 static void mdlTerminate(SimStruct *S)
 {
+	FORCESNLPsolver_destroy((FORCESNLPsolver_context *) ssGetPWork(S)[0]);
+	ssGetPWork(S)[0] = NULL;
 }
 #ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
 #include "simulink.c"      /* MEX-file interface mechanism */
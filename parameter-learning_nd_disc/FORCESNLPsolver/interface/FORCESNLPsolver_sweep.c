@@ -0,0 +1,682 @@
+/*
+FORCESNLPsolver : A fast customized optimization solver.
+
+Sweep over a queue of problems on worker processes of several machines.
+
+    FORCESNLPsolver_sweep serve QUEUE -o RESULTS [-p PORT] [-t SECONDS]
+    FORCESNLPsolver_sweep work HOST [-p PORT] [-w]
+
+serve hands out the problems of the record file QUEUE (see
+FORCESNLPsolver_record.h; only the parameters of its records are used) to the
+workers that connect to it on TCP port PORT (default 7421), and appends each
+solved problem with its result to the record file RESULTS, in the order the
+solves finish. It exits when all problems are solved, with status 0, or 1 if
+some were given up (see below).
+
+work connects to a coordinator on HOST and solves the problems it is given
+until there are none left. Each worker solves one problem at a time and only
+gets the next one once it has returned the last, so slow solves (many
+iterations) do not hold up the other workers. Start one worker process per
+core, on as many machines as wanted, before or after the coordinator; with -w
+each problem is warm started from the solution of the previous problem of the
+same worker (in queue order only if that is the only worker). The problem of a
+worker that disconnects, or with -t has not returned it within SECONDS, is
+given to another one; a problem handed out SWEEP_MAX_ATTEMPTS times without a
+result is written to RESULTS unsolved, with exitflag FORCESNLPsolver_CANCELLED,
+and counts as failed. A connection that does not introduce itself as a worker
+within SWEEP_HELLO_SECONDS is dropped, and connections are kept alive so that
+workers on machines that went down are noticed.
+
+Problems and results are sent as records in the byte order of the sending
+machine, so the coordinator only accepts workers of the same byte order and
+record layout.
+
+Built by FORCESNLPsolver_build.py --sweep, or by hand against the solver and
+the model, e.g.
+    cc -O2 FORCESNLPsolver_sweep.c -I../include -L../lib -lFORCESNLPsolver_withModel -o FORCESNLPsolver_sweep
+(add -lws2_32 on Windows).
+
+*/
+
+/* getaddrinfo, clock_gettime */
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/FORCESNLPsolver.h"
+#include "../include/FORCESNLPsolver_context.h"
+#include "../include/FORCESNLPsolver_record.h"
+
+#if defined(_WIN32)
+/* room for SWEEP_MAX_WORKERS in a select set */
+#define FD_SETSIZE (256)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+typedef SOCKET sweep_socket;
+#define SWEEP_INVALID_SOCKET INVALID_SOCKET
+#define sweep_close closesocket
+#else
+#include <netdb.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+typedef int sweep_socket;
+#define SWEEP_INVALID_SOCKET (-1)
+#define sweep_close close
+#endif
+
+extern void FORCESNLPsolver_casadi2forces(FORCESNLPsolver_float *x, FORCESNLPsolver_float *y, FORCESNLPsolver_float *l, FORCESNLPsolver_float *p, FORCESNLPsolver_float *f, FORCESNLPsolver_float *nabla_f, FORCESNLPsolver_float *c, FORCESNLPsolver_float *nabla_c, FORCESNLPsolver_float *h, FORCESNLPsolver_float *nabla_h, FORCESNLPsolver_float *hess, solver_int32_default stage);
+
+#define SWEEP_PORT        "7421"
+#define SWEEP_MAX_WORKERS (250)
+
+/* handouts of a problem before it is given up */
+#define SWEEP_MAX_ATTEMPTS (3)
+
+/* seconds a new connection has to send its hello, and the coordinator waits
+ * for the rest of a message once its first bytes came in */
+#define SWEEP_HELLO_SECONDS (10)
+
+/* index of a message that ends the work of a worker */
+#define SWEEP_DONE        (-1)
+
+/* index of a connected worker whose hello has not come in yet */
+#define SWEEP_HELLO       (-2)
+
+
+/* TIMER ----------------------------------------------------------------*/
+static double sweep_seconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double) t.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + 1e-9 * (double) t.tv_nsec;
+#endif
+}
+
+
+/* MESSAGES -------------------------------------------------------------*/
+/* sent by a worker once after connecting */
+typedef struct sweep_hello
+{
+    char magic[8];
+    solver_int32_unsigned version;
+    solver_int32_unsigned byteorder;
+    solver_int32_unsigned record_size;
+    solver_int32_unsigned reserved;
+
+} sweep_hello;
+
+/* a problem for a worker, or its result for the coordinator; the record
+ * follows the index unless that is SWEEP_DONE */
+typedef struct sweep_message
+{
+    solver_int64_default index;
+    FORCESNLPsolver_record record;
+
+} sweep_message;
+
+static void make_hello(sweep_hello *hello)
+{
+    memset(hello, 0, sizeof(sweep_hello));
+    strcpy(hello->magic, FORCESNLPsolver_RECORD_MAGIC);
+    hello->version = FORCESNLPsolver_RECORD_VERSION;
+    hello->byteorder = FORCESNLPsolver_RECORD_BYTEORDER;
+    hello->record_size = (solver_int32_unsigned) sizeof(FORCESNLPsolver_record);
+}
+
+/* 0 once all n bytes are sent, -1 if the connection failed */
+static int send_all(sweep_socket s, const void *data, size_t n)
+{
+    const char *p = (const char *) data;
+    int sent;
+
+    while( n > 0 )
+    {
+        sent = send(s, p, (int) (n < (1 << 20) ? n : (1 << 20)), 0);
+        if( sent <= 0 )
+        {
+            return -1;
+        }
+        p += sent;
+        n -= (size_t) sent;
+    }
+    return 0;
+}
+
+/* 0 once all n bytes are received, -1 if the connection failed or was closed */
+static int recv_all(sweep_socket s, void *data, size_t n)
+{
+    char *p = (char *) data;
+    int got;
+
+    while( n > 0 )
+    {
+        got = recv(s, p, (int) (n < (1 << 20) ? n : (1 << 20)), 0);
+        if( got <= 0 )
+        {
+            return -1;
+        }
+        p += got;
+        n -= (size_t) got;
+    }
+    return 0;
+}
+
+static int send_message(sweep_socket s, const sweep_message *msg)
+{
+    if( send_all(s, &msg->index, sizeof(msg->index)) != 0 )
+    {
+        return -1;
+    }
+    return msg->index == SWEEP_DONE ? 0 : send_all(s, &msg->record, sizeof(FORCESNLPsolver_record));
+}
+
+static int recv_message(sweep_socket s, sweep_message *msg)
+{
+    if( recv_all(s, &msg->index, sizeof(msg->index)) != 0 )
+    {
+        return -1;
+    }
+    return msg->index == SWEEP_DONE ? 0 : recv_all(s, &msg->record, sizeof(FORCESNLPsolver_record));
+}
+
+
+/* keep s alive, and let a receive on it fail after SWEEP_HELLO_SECONDS
+ * without data instead of waiting for good */
+static void set_timeouts(sweep_socket s)
+{
+    int yes = 1;
+#if defined(_WIN32)
+    DWORD timeout = SWEEP_HELLO_SECONDS * 1000;
+#else
+    struct timeval timeout;
+
+    timeout.tv_sec = SWEEP_HELLO_SECONDS;
+    timeout.tv_usec = 0;
+#endif
+    setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, (const char *) &yes, sizeof(yes));
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *) &timeout, sizeof(timeout));
+}
+
+
+/* COORDINATOR ----------------------------------------------------------*/
+/* a connected worker and the problem it is solving, SWEEP_DONE if idle or
+ * SWEEP_HELLO before its hello; it is given up on at deadline (0: never) */
+typedef struct sweep_worker
+{
+    sweep_socket s;
+    solver_int64_default index;
+    double deadline;
+
+} sweep_worker;
+
+typedef struct sweep_queue
+{
+    FORCESNLPsolver_record_file records;
+
+    /* next problem not handed out yet */
+    solver_int64_default next;
+
+    /* problems of disconnected workers, handed out first */
+    solver_int64_default *retry;
+    solver_int64_default nretry;
+
+    /* handouts of each problem */
+    unsigned char *attempts;
+
+    /* seconds a worker has for a problem, 0 for no limit */
+    double timeout;
+
+    /* results file, and problems written to it unsolved */
+    FORCESNLPsolver_record_writer *writer;
+    solver_int64_default nabandoned;
+
+} sweep_queue;
+
+/* problem index back into the queue, or, once it was handed out
+   SWEEP_MAX_ATTEMPTS times, unsolved into the results */
+static void requeue(sweep_queue *queue, solver_int64_default index, sweep_message *msg)
+{
+    if( queue->attempts[index] < SWEEP_MAX_ATTEMPTS )
+    {
+        queue->retry[queue->nretry++] = index;
+        return;
+    }
+    memcpy(&msg->record, &queue->records.records[index], sizeof(FORCESNLPsolver_record));
+    memset(msg->record.output, 0, sizeof(msg->record.output));
+    memset(msg->record.info, 0, sizeof(msg->record.info));
+    msg->record.exitflag = FORCESNLPsolver_CANCELLED;
+    fprintf(stderr, "problem %ld given up after %d attempts\n", (long) index, SWEEP_MAX_ATTEMPTS);
+    FORCESNLPsolver_record_write(queue->writer, &msg->record);
+    queue->nabandoned++;
+}
+
+/* close worker w, its problem if any is handed out again */
+static void drop(sweep_queue *queue, sweep_worker *w, sweep_message *msg)
+{
+    if( w->index >= 0 )
+    {
+        requeue(queue, w->index, msg);
+    }
+    sweep_close(w->s);
+    w->s = SWEEP_INVALID_SOCKET;
+    w->index = SWEEP_DONE;
+}
+
+/* problem for worker w, if any is left; a worker that cannot be sent to is closed */
+static void dispatch(sweep_queue *queue, sweep_worker *w, sweep_message *msg)
+{
+    if( queue->nretry > 0 )
+    {
+        msg->index = queue->retry[--queue->nretry];
+    }
+    else if( queue->next < queue->records.count )
+    {
+        msg->index = queue->next++;
+    }
+    else
+    {
+        return;
+    }
+    memcpy(&msg->record, &queue->records.records[msg->index], sizeof(FORCESNLPsolver_record));
+    w->index = msg->index;
+    w->deadline = queue->timeout > 0.0 ? sweep_seconds() + queue->timeout : 0.0;
+    queue->attempts[w->index]++;
+    if( send_message(w->s, msg) != 0 )
+    {
+        drop(queue, w, msg);
+    }
+}
+
+/* listening socket on port of all interfaces */
+static sweep_socket listen_on(const char *port)
+{
+    struct addrinfo hints, *res, *ai;
+    sweep_socket s = SWEEP_INVALID_SOCKET;
+    int yes = 1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if( getaddrinfo(NULL, port, &hints, &res) != 0 )
+    {
+        return SWEEP_INVALID_SOCKET;
+    }
+    for( ai = res; ai != NULL; ai = ai->ai_next )
+    {
+        s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if( s == SWEEP_INVALID_SOCKET )
+        {
+            continue;
+        }
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *) &yes, sizeof(yes));
+        if( bind(s, ai->ai_addr, (int) ai->ai_addrlen) == 0 && listen(s, 64) == 0 )
+        {
+            break;
+        }
+        sweep_close(s);
+        s = SWEEP_INVALID_SOCKET;
+    }
+    freeaddrinfo(res);
+    return s;
+}
+
+static int serve(const char *queuepath, const char *outpath, const char *port, double timeout)
+{
+    sweep_queue queue;
+    sweep_worker workers[SWEEP_MAX_WORKERS];
+    sweep_message *msg;
+    sweep_hello hello, expected;
+    sweep_socket listener, s;
+    struct timeval wait;
+    fd_set fds;
+    int nworkers = 0, peak = 0, i, j, maxfd;
+    solver_int64_default nresults = 0, noptimal = 0, nmaxit = 0;
+    double start, now;
+
+    memset(&queue, 0, sizeof(queue));
+    if( FORCESNLPsolver_record_map(queuepath, &queue.records) != 0 || queue.records.count == 0 )
+    {
+        fprintf(stderr, "%s: not a record file or no records\n", queuepath);
+        return 2;
+    }
+    if( (queue.writer = FORCESNLPsolver_record_open(outpath)) == NULL )
+    {
+        fprintf(stderr, "%s: cannot write, or not a record file of this layout\n", outpath);
+        return 2;
+    }
+    queue.timeout = timeout;
+    queue.retry = (solver_int64_default *) malloc(SWEEP_MAX_WORKERS * sizeof(solver_int64_default));
+    queue.attempts = (unsigned char *) calloc((size_t) queue.records.count, 1);
+    msg = (sweep_message *) malloc(sizeof(sweep_message));
+    if( queue.retry == NULL || queue.attempts == NULL || msg == NULL )
+    {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+    if( (listener = listen_on(port)) == SWEEP_INVALID_SOCKET )
+    {
+        fprintf(stderr, "cannot listen on port %s\n", port);
+        return 2;
+    }
+    make_hello(&expected);
+    printf("serving %ld problems on port %s\n", (long) queue.records.count, port);
+    start = sweep_seconds();
+
+    while( nresults + queue.nabandoned < queue.records.count )
+    {
+        FD_ZERO(&fds);
+        FD_SET(listener, &fds);
+        maxfd = (int) listener;
+        for( i = 0; i < nworkers; i++ )
+        {
+            FD_SET(workers[i].s, &fds);
+            maxfd = (int) workers[i].s > maxfd ? (int) workers[i].s : maxfd;
+        }
+
+        /* wake up once a second to check the deadlines */
+        wait.tv_sec = 1;
+        wait.tv_usec = 0;
+        if( select(maxfd + 1, &fds, NULL, NULL, &wait) < 0 )
+        {
+            fprintf(stderr, "select failed\n");
+            break;
+        }
+
+        /* a new connection has SWEEP_HELLO_SECONDS to send its hello */
+        if( FD_ISSET(listener, &fds) )
+        {
+            s = accept(listener, NULL, NULL);
+            if( s != SWEEP_INVALID_SOCKET )
+            {
+#if !defined(_WIN32)
+                if( s >= FD_SETSIZE )
+                {
+                    sweep_close(s);
+                }
+                else
+#endif
+                if( nworkers == SWEEP_MAX_WORKERS )
+                {
+                    fprintf(stderr, "worker rejected: too many workers\n");
+                    sweep_close(s);
+                }
+                else
+                {
+                    set_timeouts(s);
+                    workers[nworkers].s = s;
+                    workers[nworkers].index = SWEEP_HELLO;
+                    workers[nworkers].deadline = sweep_seconds() + SWEEP_HELLO_SECONDS;
+                    nworkers++;
+                }
+            }
+        }
+
+        /* a hello, after which the worker gets its first problem at once, a
+           result, or a worker gone whose problem is handed out again */
+        for( i = 0; i < nworkers; i++ )
+        {
+            if( workers[i].s == SWEEP_INVALID_SOCKET || !FD_ISSET(workers[i].s, &fds) )
+            {
+                continue;
+            }
+            if( workers[i].index == SWEEP_HELLO )
+            {
+                if( recv_all(workers[i].s, &hello, sizeof(hello)) != 0 || memcmp(&hello, &expected, sizeof(hello)) != 0 )
+                {
+                    fprintf(stderr, "worker rejected: another record layout\n");
+                    drop(&queue, &workers[i], msg);
+                    continue;
+                }
+                workers[i].index = SWEEP_DONE;
+                workers[i].deadline = 0.0;
+                dispatch(&queue, &workers[i], msg);
+                continue;
+            }
+            if( recv_message(workers[i].s, msg) != 0 || msg->index != workers[i].index )
+            {
+                drop(&queue, &workers[i], msg);
+                continue;
+            }
+            if( FORCESNLPsolver_record_write(queue.writer, &msg->record) != 0 )
+            {
+                fprintf(stderr, "%s: write error\n", outpath);
+            }
+            nresults++;
+            noptimal += msg->record.exitflag == FORCESNLPsolver_OPTIMAL;
+            nmaxit += msg->record.exitflag == FORCESNLPsolver_MAXITREACHED;
+            workers[i].index = SWEEP_DONE;
+            workers[i].deadline = 0.0;
+            dispatch(&queue, &workers[i], msg);
+        }
+
+        /* connections silent since accept, or problems out for too long */
+        now = sweep_seconds();
+        for( i = 0; i < nworkers; i++ )
+        {
+            if( workers[i].s != SWEEP_INVALID_SOCKET && workers[i].deadline > 0.0 && now > workers[i].deadline )
+            {
+                if( workers[i].index >= 0 )
+                {
+                    fprintf(stderr, "problem %ld not returned within %g s\n", (long) workers[i].index, queue.timeout);
+                }
+                drop(&queue, &workers[i], msg);
+            }
+        }
+
+        /* drop closed workers, give retried problems to idle ones */
+        for( i = 0, j = 0; i < nworkers; i++ )
+        {
+            if( workers[i].s != SWEEP_INVALID_SOCKET )
+            {
+                workers[j++] = workers[i];
+            }
+        }
+        nworkers = j;
+        for( i = 0; i < nworkers && queue.nretry > 0; i++ )
+        {
+            if( workers[i].index == SWEEP_DONE )
+            {
+                dispatch(&queue, &workers[i], msg);
+            }
+        }
+        peak = nworkers > peak ? nworkers : peak;
+    }
+
+    msg->index = SWEEP_DONE;
+    for( i = 0; i < nworkers; i++ )
+    {
+        send_message(workers[i].s, msg);
+        sweep_close(workers[i].s);
+    }
+    sweep_close(listener);
+    printf("%ld problems, %ld optimal, %ld maxit, %ld failed (%ld given up) in %.1f s on up to %d workers\n", (long) (nresults + queue.nabandoned),
+           (long) noptimal, (long) nmaxit, (long) (nresults + queue.nabandoned - noptimal - nmaxit), (long) queue.nabandoned, sweep_seconds() - start, peak);
+
+    free(msg);
+    free(queue.attempts);
+    free(queue.retry);
+    FORCESNLPsolver_record_unmap(&queue.records);
+    if( FORCESNLPsolver_record_close(queue.writer) != 0 )
+    {
+        fprintf(stderr, "%s: not all results written\n", outpath);
+        return 2;
+    }
+    if( nresults + queue.nabandoned != queue.records.count )
+    {
+        return 2;
+    }
+    return queue.nabandoned > 0 ? 1 : 0;
+}
+
+
+/* WORKER ---------------------------------------------------------------*/
+static sweep_socket connect_to(const char *host, const char *port)
+{
+    struct addrinfo hints, *res, *ai;
+    sweep_socket s = SWEEP_INVALID_SOCKET;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if( getaddrinfo(host, port, &hints, &res) != 0 )
+    {
+        return SWEEP_INVALID_SOCKET;
+    }
+    for( ai = res; ai != NULL; ai = ai->ai_next )
+    {
+        s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if( s == SWEEP_INVALID_SOCKET )
+        {
+            continue;
+        }
+        if( connect(s, ai->ai_addr, (int) ai->ai_addrlen) == 0 )
+        {
+            break;
+        }
+        sweep_close(s);
+        s = SWEEP_INVALID_SOCKET;
+    }
+    freeaddrinfo(res);
+    return s;
+}
+
+static int work(const char *host, const char *port, int warm)
+{
+    FORCESNLPsolver_context *ctx;
+    FORCESNLPsolver_params params;
+    sweep_message *msg;
+    sweep_hello hello;
+    sweep_socket s;
+    long nsolved = 0;
+    int yes = 1;
+
+    if( (s = connect_to(host, port)) == SWEEP_INVALID_SOCKET )
+    {
+        fprintf(stderr, "cannot connect to %s:%s\n", host, port);
+        return 2;
+    }
+    msg = (sweep_message *) malloc(sizeof(sweep_message));
+    ctx = FORCESNLPsolver_create(FORCESNLPsolver_casadi2forces);
+    if( msg == NULL || ctx == NULL )
+    {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+    ctx->warmstart = warm ? FORCESNLPsolver_WARMSTART_REUSE : FORCESNLPsolver_WARMSTART_OFF;
+    setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, (const char *) &yes, sizeof(yes));
+    make_hello(&hello);
+    if( send_all(s, &hello, sizeof(hello)) != 0 )
+    {
+        fprintf(stderr, "connection to %s:%s lost\n", host, port);
+        return 2;
+    }
+
+    /* the result is recorded with the parameters as given, not the warm start */
+    while( recv_message(s, msg) == 0 && msg->index != SWEEP_DONE )
+    {
+        FORCESNLPsolver_record_params(&msg->record, &params);
+        memcpy(&ctx->params, &params, sizeof(FORCESNLPsolver_params));
+        FORCESNLPsolver_solve_ctx(ctx);
+        FORCESNLPsolver_record_fill(&msg->record, &params, &ctx->output, &ctx->info, ctx->exitflag);
+        if( send_message(s, msg) != 0 )
+        {
+            break;
+        }
+        nsolved++;
+    }
+    printf("%ld problems solved\n", nsolved);
+
+    sweep_close(s);
+    FORCESNLPsolver_destroy(ctx);
+    free(msg);
+    return 0;
+}
+
+
+/* MAIN -----------------------------------------------------------------*/
+static void usage(void)
+{
+    fprintf(stderr, "usage: FORCESNLPsolver_sweep serve QUEUE -o RESULTS [-p PORT] [-t SECONDS]\n"
+                    "       FORCESNLPsolver_sweep work HOST [-p PORT] [-w]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *target = NULL, *outpath = NULL, *port = SWEEP_PORT;
+    int warm = 0, i, status;
+    double timeout = 0.0;
+#if defined(_WIN32)
+    WSADATA wsa;
+#endif
+
+    if( argc < 3 || (strcmp(argv[1], "serve") != 0 && strcmp(argv[1], "work") != 0) )
+    {
+        usage();
+    }
+    for( i = 2; i < argc; i++ )
+    {
+        if( argv[i][0] != '-' )
+        {
+            target = argv[i];
+        }
+        else if( strcmp(argv[i], "-w") == 0 )
+        {
+            warm = 1;
+        }
+        else if( i + 1 >= argc )
+        {
+            usage();
+        }
+        else if( strcmp(argv[i], "-o") == 0 )
+        {
+            outpath = argv[++i];
+        }
+        else if( strcmp(argv[i], "-p") == 0 )
+        {
+            port = argv[++i];
+        }
+        else if( strcmp(argv[i], "-t") == 0 )
+        {
+            timeout = atof(argv[++i]);
+        }
+        else
+        {
+            usage();
+        }
+    }
+    if( target == NULL || (argv[1][0] == 's' && outpath == NULL) )
+    {
+        usage();
+    }
+
+#if defined(_WIN32)
+    if( WSAStartup(MAKEWORD(2, 2), &wsa) != 0 )
+    {
+        fprintf(stderr, "cannot start Winsock\n");
+        return 2;
+    }
+#else
+    /* a closed connection is seen by send instead */
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    status = argv[1][0] == 's' ? serve(target, outpath, port, timeout) : work(target, port, warm);
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+    return status;
+}